@@ -0,0 +1,266 @@
+#include <benchmark/benchmark.h>
+#include "../src/random.hpp"
+#include "../src/network.hpp"
+#include "../src/neuronPool.hpp"
+#include "../src/replicaBatch.hpp"
+#include "../src/kernels.hpp"
+#include "../src/spikeWriter.hpp"
+#include "../src/constants.hpp"
+#include <sstream>
+#include <algorithm>
+#include <numeric>
+#include <random>
+#include <memory>
+#include <string>
+#include <vector>
+
+/*
+ * Run with --benchmark_format=json (or --benchmark_out=results.json --benchmark_out_format=json)
+ * to get machine-readable results. The counters are:
+ *  - steps/s: simulation steps per second
+ *  - neurons/s: neuron updates per second
+ *  - events/s: synaptic events (spike x outgoing connection) delivered per second
+ *  - bytes/neuron: memory of the network, or output written per neuron and per step
+ */
+
+namespace {
+
+//seed of the generators of the benchmarks
+const uint64_t SEED(20180101);
+const char MODELS[] = {'b', 'c', 'o'};
+const char FORMATS[] = {'t', 'b', 'a', 'e'};
+
+//memory used by a network: the pool of neurons, in double or float, and the connections in their precision,
+//twice in event mode where the transposed matrix has the same size
+double networkBytes(const Network& net) {
+    const NeuronPool& neurons(net.getNeurons());
+    const size_t state(neurons.isSinglePrecision() ? sizeof(float) : sizeof(double));
+    return net.getCon().bytes()*(net.getPropagation() == 'e' ? 2 : 1)
+           + neurons.size()*(7*state + (NeuronPool::COLUMNS - 7)*sizeof(double) + sizeof(unsigned char));
+}
+
+//number of synaptic events delivered by the spikes of a step
+uint64_t events(const std::vector<uint64_t>& spikes, const SynapseMatrix& outgoing) {
+    uint64_t count(0);
+    for (size_t word(0); word < spikes.size(); ++word) {
+        for (uint64_t bits(spikes[word]); bits != 0; bits &= bits - 1) {
+            count += outgoing.degree(64*word + __builtin_ctzll(bits));
+        }
+    }
+    return count;
+}
+
+//network whose neurons each receive the connections of their lambda nearest neighbours on a ring, numbered in a random order
+//within each run of neurons of the same type: the connectivity is local, but not in the order of the indices, as for a network made by another program
+Network* localNetwork(int nb, int lambda, Random& random) {
+    const Network built('c', nb, _PERC_, _INT_, lambda, _DEL_, random, 'p');
+    //ring[p] is the neuron at the position p of the ring, the positions of a run being the indices of the run
+    std::vector<int> ring(nb), position(nb);
+    std::iota(ring.begin(), ring.end(), 0);
+    std::mt19937_64 shuffle(SEED);
+    for (const TypeBlock& block: built.getBlocks()) {
+        std::shuffle(ring.begin() + block.begin, ring.begin() + block.end, shuffle);
+    }
+    for (int p(0); p < nb; ++p) {
+        position[ring[p]] = p;
+    }
+    std::vector<size_t> offsets(1, 0);
+    std::vector<int> sources;
+    std::vector<double> weights;
+    for (int i(0); i < nb; ++i) {
+        //neighbours at distance 1, -1, 2, -2...
+        for (int k(0); k < lambda; ++k) {
+            const int distance(k % 2 ? -(k / 2 + 1) : k / 2 + 1);
+            sources.push_back(ring[((position[i] + distance) % nb + nb) % nb]);
+        }
+        std::sort(sources.begin() + offsets.back(), sources.end());
+        for (size_t k(offsets.back()); k < sources.size(); ++k) {
+            weights.push_back(built.getNeurons().factor(sources[k])*random.uniform_double(0, 2*_INT_));
+        }
+        offsets.push_back(sources.size());
+    }
+    return new Network(built, SynapseMatrix(offsets, sources, weights), random);
+}
+
+}
+
+//integration of N neurons for one step by each kernel, args: N, index of the kernel
+static void BM_Integration(benchmark::State& state) {
+    const std::vector<std::string> kernels(availableKernels());
+    if (size_t(state.range(1)) >= kernels.size()) {
+        state.SkipWithError("kernel not available on this processor");
+        return;
+    }
+    const size_t nb(state.range(0));
+    Random random(SEED);
+    NeuronPool pool;
+    pool.setKernel(kernels[state.range(1)]);
+    for (size_t i(0); i < nb; ++i) {
+        pool.add("RS", _EXCIT_W_, _EXCIT_FACTOR_);
+        pool.setAttributs(i, _RS_A_, _RS_B_, _RS_C_, _RS_D_);
+        pool.setCurrent(i, 5*random.normal(0, 1));
+    }
+    std::vector<uint64_t> spikes((nb + 63) / 64);
+    for (auto _ : state) {
+        pool.update(0, nb, spikes.data());
+        benchmark::DoNotOptimize(spikes.data());
+    }
+    state.SetLabel(kernels[state.range(1)]);
+    state.counters["steps/s"] = benchmark::Counter(state.iterations(), benchmark::Counter::kIsRate);
+    state.counters["neurons/s"] = benchmark::Counter(state.iterations()*nb, benchmark::Counter::kIsRate);
+}
+BENCHMARK(BM_Integration)->ArgsProduct({{1 << 10, 1 << 14, 1 << 18}, {0, 1, 2}});
+
+//one update of the network (synaptic currents and integration), args: N, lambda, model, propagation (0 scan, 1 event)
+static void BM_Update(benchmark::State& state) {
+    const int nb(state.range(0));
+    Random random(SEED);
+    Network net(MODELS[state.range(2)], nb, _PERC_, _INT_, std::min<double>(state.range(1), nb - 1), _DEL_, random, 'p');
+    net.setPropagation(state.range(3) ? 'e' : 's');
+    const SynapseMatrix outgoing(net.getCon().transpose());
+    uint64_t delivered(0);
+    for (auto _ : state) {
+        delivered += events(net.getSpikes(), outgoing);
+        net.update();
+    }
+    state.SetLabel(std::string(1, MODELS[state.range(2)]) + (state.range(3) ? " event" : " scan"));
+    state.counters["steps/s"] = benchmark::Counter(state.iterations(), benchmark::Counter::kIsRate);
+    state.counters["neurons/s"] = benchmark::Counter(state.iterations()*nb, benchmark::Counter::kIsRate);
+    state.counters["events/s"] = benchmark::Counter(delivered, benchmark::Counter::kIsRate);
+    state.counters["bytes/neuron"] = networkBytes(net) / nb;
+}
+BENCHMARK(BM_Update)->ArgsProduct({{1000, 10000, 100000}, {10, 100}, {0, 1, 2}, {0, 1}})->Unit(benchmark::kMillisecond);
+
+//one update with transmission delays between 1 and D steps, delivered through the ring of inputs, args: N, lambda, D
+static void BM_Delays(benchmark::State& state) {
+    const int nb(state.range(0));
+    Random random(SEED);
+    Network net(_MOD_, nb, _PERC_, _INT_, std::min<double>(state.range(1), nb - 1), _DEL_, random, 'p');
+    net.setDelays(state.range(2), 1);
+    for (auto _ : state) {
+        net.update();
+    }
+    state.counters["steps/s"] = benchmark::Counter(state.iterations(), benchmark::Counter::kIsRate);
+    state.counters["neurons/s"] = benchmark::Counter(state.iterations()*nb, benchmark::Counter::kIsRate);
+}
+BENCHMARK(BM_Delays)->ArgsProduct({{10000, 100000}, {10, 100}, {1, 20}})->Unit(benchmark::kMillisecond);
+
+//one synchronous update reading the weights in double, float or 16-bit integers and the neurons in double or float, args: N, lambda, precision, propagation (0 scan, 1 event)
+static void BM_Precision(benchmark::State& state) {
+    static const char PRECISIONS[] = {'d', 'f', 'h'};
+    const int nb(state.range(0));
+    Random random(SEED);
+    Network net(_MOD_, nb, _PERC_, _INT_, std::min<double>(state.range(1), nb - 1), _DEL_, random, 'p');
+    net.setPropagation(state.range(3) ? 'e' : 's');
+    net.setSynchronous(true);
+    net.setPrecision(PRECISIONS[state.range(2)]);
+    for (auto _ : state) {
+        net.update();
+    }
+    state.SetLabel(std::string(1, PRECISIONS[state.range(2)]) + (state.range(3) ? " event" : " scan"));
+    state.counters["steps/s"] = benchmark::Counter(state.iterations(), benchmark::Counter::kIsRate);
+    state.counters["neurons/s"] = benchmark::Counter(state.iterations()*nb, benchmark::Counter::kIsRate);
+    state.counters["bytes/neuron"] = networkBytes(net) / nb;
+}
+BENCHMARK(BM_Precision)->ArgsProduct({{100000}, {10, 100}, {0, 1, 2}, {0, 1}})->Unit(benchmark::kMillisecond);
+
+//one synchronous update of a network with local connectivity, shuffled or reordered, args: N, lambda, reordered, propagation (0 scan, 1 event)
+static void BM_Reorder(benchmark::State& state) {
+    const int nb(state.range(0));
+    Random random(SEED);
+    std::unique_ptr<Network> local(localNetwork(nb, std::min<int>(state.range(1), nb - 1), random));
+    Network& net(*local);
+    if (state.range(2)) {
+        net.reorder();
+    }
+    net.setPropagation(state.range(3) ? 'e' : 's');
+    net.setSynchronous(true);
+    const SynapseMatrix outgoing(net.getCon().transpose());
+    uint64_t delivered(0);
+    for (auto _ : state) {
+        delivered += events(net.getSpikes(), outgoing);
+        net.update();
+    }
+    state.SetLabel(std::string(state.range(2) ? "reordered" : "shuffled") + (state.range(3) ? " event" : " scan"));
+    state.counters["steps/s"] = benchmark::Counter(state.iterations(), benchmark::Counter::kIsRate);
+    state.counters["neurons/s"] = benchmark::Counter(state.iterations()*nb, benchmark::Counter::kIsRate);
+    state.counters["events/s"] = benchmark::Counter(delivered, benchmark::Counter::kIsRate);
+}
+BENCHMARK(BM_Reorder)->ArgsProduct({{1000000}, {10, 40}, {0, 1}, {0, 1}})->Unit(benchmark::kMillisecond);
+
+//one update of R replicas of the network walking the connections once, args: N, lambda, R
+static void BM_Replicas(benchmark::State& state) {
+    const int nb(state.range(0));
+    const size_t replicas(state.range(2));
+    Random random(SEED);
+    Network net(_MOD_, nb, _PERC_, _INT_, std::min<double>(state.range(1), nb - 1), _DEL_, random, 'p');
+    net.setSynchronous(true);
+    ReplicaBatch batch(net, replicas);
+    for (auto _ : state) {
+        batch.update();
+    }
+    state.counters["steps/s"] = benchmark::Counter(state.iterations()*replicas, benchmark::Counter::kIsRate);
+    state.counters["neurons/s"] = benchmark::Counter(state.iterations()*nb*replicas, benchmark::Counter::kIsRate);
+}
+BENCHMARK(BM_Replicas)->ArgsProduct({{10000, 100000}, {10, 100}, {1, 8, 32}})->Unit(benchmark::kMillisecond);
+
+//construction of a network, args: N, lambda, model, construction (0 sequential, 1 parallel)
+static void BM_Construction(benchmark::State& state) {
+    const int nb(state.range(0));
+    const double lambda(std::min<double>(state.range(1), nb - 1));
+    double bytes(0);
+    for (auto _ : state) {
+        Random random(SEED);
+        Network net(MODELS[state.range(2)], nb, _PERC_, _INT_, lambda, _DEL_, random, state.range(3) ? 'p' : 's');
+        bytes = networkBytes(net);
+        benchmark::DoNotOptimize(net.getCon().nonZeros());
+    }
+    state.SetLabel(std::string(1, MODELS[state.range(2)]) + (state.range(3) ? " parallel" : " sequential"));
+    state.counters["neurons/s"] = benchmark::Counter(state.iterations()*nb, benchmark::Counter::kIsRate);
+    state.counters["bytes/neuron"] = bytes / nb;
+}
+BENCHMARK(BM_Construction)->ArgsProduct({{10000, 100000}, {10, 100}, {0, 1, 2}, {0, 1}})->Unit(benchmark::kMillisecond);
+
+//formatting of the spikes of one step by each writer, args: N, index of the format
+static void BM_Output(benchmark::State& state) {
+    const size_t nb(state.range(0));
+    NeuronPool pool;
+    for (size_t i(0); i < nb; ++i) pool.add("RS", _EXCIT_W_, _EXCIT_FACTOR_);
+    RasterHeader header(RasterHeader::layout(pool));
+    //about 2% of the neurons fire at each step
+    Random random(SEED);
+    std::vector<std::vector<uint64_t>> steps(64, std::vector<uint64_t>((nb + 63) / 64, 0));
+    for (auto& spikes: steps) {
+        for (size_t i(0); i < nb; ++i) {
+            if (random.bernoulli(.02)) spikes[i / 64] |= uint64_t(1) << (i % 64);
+        }
+    }
+    std::ostringstream out;
+    std::unique_ptr<SpikeWriter> writer;
+    switch (FORMATS[state.range(1)]) {
+        case 'b': writer.reset(new BinaryRasterWriter(out, header)); break;
+        case 'a': writer.reset(new EventTextWriter(out, nb)); break;
+        case 'e': writer.reset(new EventBinaryWriter(out, header)); break;
+        default: writer.reset(new TextRasterWriter(out, nb));
+    }
+    int step(0);
+    double bytes(0);
+    for (auto _ : state) {
+        writer->write(step + 1, steps[step % steps.size()]);
+        step += 1;
+        if (step % steps.size() == 0) {
+            writer->flush();
+            bytes += out.tellp();
+            out.str("");
+        }
+    }
+    writer->flush();
+    bytes += out.tellp();
+    state.SetLabel(std::string(1, FORMATS[state.range(1)]));
+    state.counters["steps/s"] = benchmark::Counter(state.iterations(), benchmark::Counter::kIsRate);
+    state.counters["bytes/s"] = benchmark::Counter(bytes, benchmark::Counter::kIsRate);
+    state.counters["bytes/neuron"] = bytes / (double(state.iterations())*nb);
+}
+BENCHMARK(BM_Output)->ArgsProduct({{10000, 100000}, {0, 1, 2, 3}});
+
+BENCHMARK_MAIN();
@@ -0,0 +1,87 @@
+#include "checkpoint.hpp"
+#include <fstream>
+#include <cstdio>
+#include <cstring>
+#include <stdexcept>
+
+namespace {
+
+const char CHECKPOINT_MAGIC[8] = {'I', 'Z', 'C', 'H', 'E', 'C', 'K', 'P'};
+const uint32_t CHECKPOINT_VERSION(2);
+
+template<class T> void writeValue(std::ostream& out, const T& value) {
+    out.write(reinterpret_cast<const char*>(&value), sizeof(value));
+}
+
+void writeString(std::ostream& out, const std::string& value) {
+    writeValue<uint64_t>(out, value.size());
+    out.write(value.data(), value.size());
+}
+
+template<class T> T readValue(std::istream& in) {
+    T value;
+    if (not in.read(reinterpret_cast<char*>(&value), sizeof(value))) {
+        throw std::runtime_error("The checkpoint is truncated");
+    }
+    return value;
+}
+
+std::string readString(std::istream& in) {
+    std::string value(readValue<uint64_t>(in), '\0');
+    if (not in.read(&value[0], value.size())) {
+        throw std::runtime_error("The checkpoint is truncated");
+    }
+    return value;
+}
+
+}
+
+void Checkpoint::write(const std::string& file) const {
+    const std::string temporary(file + ".tmp");
+    {
+        std::ofstream out(temporary, std::ios::out | std::ios::binary);
+        out.write(CHECKPOINT_MAGIC, sizeof(CHECKPOINT_MAGIC));
+        writeValue(out, CHECKPOINT_VERSION);
+        writeValue<int64_t>(out, step);
+        writeValue(out, time);
+        writeString(out, output);
+        writeValue(out, format);
+        writeValue<char>(out, options);
+        writeValue(out, outputSize);
+        writeValue(out, samplesSize);
+        writeValue(out, writerState);
+        writeString(out, random);
+        writeString(out, network);
+        writeValue(out, seed);
+        if (not out.flush()) {
+            throw std::runtime_error("The checkpoint " + temporary + " could not be written");
+        }
+    }
+    if (std::rename(temporary.c_str(), file.c_str()) != 0) {
+        throw std::runtime_error("The checkpoint " + file + " could not be written");
+    }
+}
+
+Checkpoint Checkpoint::read(const std::string& file) {
+    std::ifstream in(file, std::ios::in | std::ios::binary);
+    char magic[8];
+    if (not in.read(magic, sizeof(magic)) or std::memcmp(magic, CHECKPOINT_MAGIC, sizeof(magic)) != 0) {
+        throw std::runtime_error("The file " + file + " is not a checkpoint");
+    }
+    if (readValue<uint32_t>(in) != CHECKPOINT_VERSION) {
+        throw std::runtime_error("This version of checkpoint is not supported");
+    }
+    Checkpoint checkpoint;
+    checkpoint.step = readValue<int64_t>(in);
+    checkpoint.time = readValue<double>(in);
+    checkpoint.output = readString(in);
+    checkpoint.format = readValue<char>(in);
+    checkpoint.options = readValue<char>(in);
+    checkpoint.outputSize = readValue<uint64_t>(in);
+    checkpoint.samplesSize = readValue<uint64_t>(in);
+    checkpoint.writerState = readValue<uint64_t>(in);
+    checkpoint.random = readString(in);
+    checkpoint.network = readString(in);
+    checkpoint.seed = readValue<uint64_t>(in);
+    return checkpoint;
+}
@@ -0,0 +1,52 @@
+#ifndef CHECKPOINT_HPP
+#define CHECKPOINT_HPP
+#include <string>
+#include <cstdint>
+
+
+/**
+ * @brief State of a simulation after a step, from which it can be resumed.
+ *
+ * The state of the network and of the random generator are taken by the simulation loop,
+ * the positions reached in the output files by the thread writing them, once the step is written.
+ * The network itself is saved once, in a snapshot next to the checkpoint (see \ref Network::save).
+ */
+struct Checkpoint {
+    ///last step done
+    int step;
+    ///simulated time at the end of this step
+    double time;
+    ///name of the output file of the spikes
+    std::string output;
+    ///format of this file
+    char format;
+    ///tells if the variables of the neurons are sampled
+    bool options;
+    ///size of the output file of the spikes once the step is written
+    uint64_t outputSize;
+    ///size of the samples file once the step is written
+    uint64_t samplesSize;
+    ///state of the writer of the spikes (see \ref SpikeWriter::getState)
+    uint64_t writerState;
+    ///state of the random generator (see \ref Random::getState)
+    std::string random;
+    ///state of the network (see \ref Network::getState)
+    std::string network;
+    ///seed given to the simulation, written again in the header of a resumed binary output
+    uint64_t seed;
+
+    /*! @brief Writes the checkpoint in a temporary file, renamed once complete, so that a previous checkpoint is only replaced by a whole one
+     *  @note Throws a runtime error if the file cannot be written
+     */
+    void write(const std::string& file) const;
+
+    /*! @brief Reads a checkpoint
+     *  @note Throws a runtime error if the file is not a valid checkpoint
+     */
+    static Checkpoint read(const std::string& file);
+
+    /*! @brief Name of the snapshot of the network saved with a checkpoint file*/
+    static std::string networkFile(const std::string& file) {return file + ".network";};
+};
+
+#endif //CHECKPOINT_HPP
@@ -8,6 +8,16 @@
 #define _LAMB_ 10
 #define _INT_ 20
 #define _MOD_ 'b'
+#define _PROP_ 's'
+#define _CONSTRUCTION_ 's'
+#define _THREADS_ 1
+#define _ALIGN_ 64
+#define _SWEEP_ "L=10,20,30;l=5:20:5"
+#define _REPLICAS_ 1
+#define _SEED_ 0
+#define _DELAY_ 0
+#define _PRECISION_ 'd'
+#define _QUEUE_ 64
 #define _DEL_ .05
 #define _OPT_ false
 #define _DISCHARGE_T_ 30
@@ -17,6 +27,11 @@
 #define _SAMPLES_ "samples"
 #define _PATH_OUTFILE_ "../"
 #define _EXTENSION_ ".txt"
+#define _EXTENSION_BIN_ ".bin"
+#define _FORMAT_ 't'
+#define _CHECKPOINT_ "checkpoint.bin"
+#define _SUMMARY_ "summary.txt"
+#define _CHECKPOINT_EVERY_ 0
 #define _PATH_TEST_ "test/"
 
 #define _INIT_V_ -65
@@ -72,7 +87,28 @@
 #define _LAMBDA_ "Mean connectivity between the neurons"
 #define _INTENSITY_ "Mean intensity of a connection"
 #define _PRGRM_TEXT_ "Neuron simulation"
+#define _CONVERT_TEXT_ "Conversion of a binary raster of neuron_network to a text raster, the rasters of the ranks of a distributed simulation (-M) being merged in the order of the ranks"
 #define _OFILE_TEXT_ "Output file name"
+#define _FORMAT_TEXT_ "Format of the output file, 't' for a text raster, 'b' for a binary raster (one bit per neuron, see raster2text), 'a' for text events (one line per spike), 'e' for delta-encoded binary events and 'n' for no output of the spikes, only their statistics (-A) being written"
 #define _MODEL_TEXT_ "Model for neuron connections,'b' for basic, 'c' for constant and 'o' for overdispersed"
+#define _PROP_TEXT_ "Computation of the synaptic currents, 's' for scan of all connections and 'e' for event-driven propagation of the spikes"
+#define _THREADS_TEXT_ "Number of threads building the network (with -C p) or updating it (only with a synchronous update)"
+#define _CONSTRUCTION_TEXT_ "Construction of the connections, 's' for sequential draws and 'p' for a parallel construction with one random stream per neuron"
+#define _SYNC_TEXT_ "Synchronous update: all neurons read the spikes of the previous step (always the case with the event-driven propagation)"
 #define _D_TEXT_ "Tunable number for neuron parameters creation"
+#define _LOAD_TEXT_ "Network snapshot written with -W, from which the network is loaded instead of being built (the options -N, -p, -T, -m, -l, -L, -d and -C are then ignored)"
+#define _SAVE_TEXT_ "File in which a snapshot of the network is written once built, to be loaded with -R"
+#define _CHECKPOINT_EVERY_TEXT_ "Number of steps between two checkpoints of the simulation, 0 for none"
+#define _CHECKPOINT_TEXT_ "Checkpoint file, the network being saved next to it (with the extension .network)"
+#define _RESUME_TEXT_ "Resumes the simulation from the checkpoint until the end time, with the network, outputs and options of the checkpointed simulation"
+#define _SWEEP_TEXT_ "Runs the simulation over a grid of L, l, p and d, as key=values separated by ';', the values being separated by ',' or given as first:last:step. The runs share the connections when only L and d change, are done by the threads given with -j and write their spikes in numbered files listed in an index file"
+#define _REPLICAS_TEXT_ "Number of replicas of the network, at most 64, which only differ by their noise: they are updated together by a synchronous scan walking the connections once per step, and each one is written in a numbered output file"
+#define _SEED_TEXT_ "Seed of the random generator, 0 to draw one: the parameters of the neurons, the connections and the noise are drawn from independent streams of this seed, which is written at the beginning of the outputs"
+#define _STATISTICS_TEXT_ "Summary file of the statistics of the spikes computed during the simulation: the rates of each type and of the population, then for each neuron its rate and the mean and coefficient of variation of its interspike intervals. The population rate of each step is written next to it, in a file ending with _population"
+#define _DELAY_TEXT_ "Largest transmission delay of the connections, in steps, 0 for none: each connection gets a delay drawn uniformly between 1 and this number of steps, 1 being the delay of the synchronous update, and the spikes are delivered by the event-driven propagation"
+#define _PRECISION_TEXT_ "Precision of the synaptic weights read by the update: d for double, f for float, h for 16-bit integers in units of the smallest power of two whose 32767 multiples reach the largest weight. The reduced precisions halve or quarter the memory of the connections, store and integrate the state of the neurons in float, and force a synchronous update"
+#define _PRECISION_REPORT_TEXT_ "Runs the network again with double weights after the simulation, from the same seed, and compares the weights and the rates of each type and of the population on the standard error"
+#define _MPI_TEXT_ "Distributed simulation: each process started by mpirun (rank) builds and updates its range of neurons, the ranks exchanging their spikes at each step. The network is the one of the parallel construction (-C p) updated synchronously (-S), and each rank writes the spikes of its neurons in a numbered binary file (-f b or e, e by default), merged by raster2text"
+#define _REORDER_TEXT_ "Renumbers the neurons once the network is built, in the reverse Cuthill-McKee order of the connections within each type, so that connected neurons are stored close to each other, which speeds up the event propagation of networks loaded with local connections. The neurons keep their noise, and the outputs keep the original order of the neurons"
+#define _PROFILE_TEXT_ "Times the phases of the simulation (construction, synaptic currents, update, outputs) and counts the spikes, synaptic events and bytes written, the summary being written on the standard error at the end"
 #define _OPTION_TEXT_ "Choice of optional output of supplementary files parameters and sample"
@@ -0,0 +1,153 @@
+#include "distributedNetwork.hpp"
+#include "network.hpp"
+#include "inhibitoryNeuron.hpp"
+#include "excitatoryNeuron.hpp"
+#include "random.hpp"
+#include <algorithm>
+#include <memory>
+#include <stdexcept>
+
+size_t DistributedNetwork::first(size_t nb, size_t rank, size_t ranks) {
+    const size_t words((nb + 63) / 64);
+    return std::min(nb, 64 * (words * rank / ranks));
+}
+
+std::array<int, NEURON_TYPES> DistributedNetwork::typeCounts(int nb, double p_E) {
+    std::array<int, NEURON_TYPES> counts = {};
+    const int excit(p_E * nb);
+    counts[size_t(NeuronType::FS)] = nb - excit;
+    counts[size_t(NeuronType::RS)] = excit;
+    return counts;
+}
+
+std::array<int, NEURON_TYPES> DistributedNetwork::typeCounts(int nb, double p_FS, double p_IB, double p_RZ, double p_LTS, double p_TC, double p_CH) {
+    std::array<int, NEURON_TYPES> counts = {};
+    counts[size_t(NeuronType::FS)] = nb*p_FS;
+    counts[size_t(NeuronType::LTS)] = nb*p_LTS;
+    counts[size_t(NeuronType::IB)] = nb*p_IB;
+    counts[size_t(NeuronType::RZ)] = nb*p_RZ;
+    counts[size_t(NeuronType::TC)] = nb*p_TC;
+    counts[size_t(NeuronType::CH)] = nb*p_CH;
+    int others(0);
+    for (auto count: counts) {
+        others += count;
+    }
+    counts[size_t(NeuronType::RS)] = nb - others;
+    return counts;
+}
+
+DistributedNetwork::DistributedNetwork(size_t rank, size_t ranks, char model, const std::array<int, NEURON_TYPES>& counts, double intensity,
+                                       double lambda, double delta, uint64_t noiseSeed, Random& random, size_t threads)
+    : _rank(rank), _ranks(ranks), _nb(0), _noiseSeed(noiseSeed), _step(0)
+{
+    if (ranks == 0 or rank >= ranks) {
+        throw std::domain_error("The rank " + std::to_string(rank) + " is not one of the " + std::to_string(ranks) + " ranks");
+    }
+    //type of each neuron of the network, whose runs are given by the counts
+    std::vector<unsigned char> types;
+    for (size_t type(0); type < NEURON_TYPES; type++) {
+        types.insert(types.end(), std::max(counts[type], 0), (unsigned char)type);
+    }
+    _nb = types.size();
+    _begin = first(_nb, rank, ranks);
+    _end = first(_nb, rank + 1, ranks);
+    _neurons.reserve(_end - _begin);
+    const double lowerbound(1 - delta);
+    const double upperbound(1 + delta);
+    for (size_t i(0); i < _nb; i++) {
+        const TypeTraits& traits(TYPE_TRAITS[types[i]]);
+        if (i < _begin or i >= _end) {
+            //the neurons of the other ranks draw their attributes a, b, c, d as their constructors do, and are dropped
+            for (int k(0); k < 4; k++) {
+                random.uniform_double(lowerbound, upperbound);
+            }
+        }
+        else if (traits.excitatory) {
+            std::unique_ptr<Neuron> neuron(new ExcitatoryNeuron(delta, random, traits.name, &_neurons));
+        }
+        else {
+            std::unique_ptr<Neuron> neuron(new InhibitoryNeuron(delta, random, traits.name, &_neurons));
+        }
+    }
+    Random topology(random.substream(Random::TOPOLOGY));
+    _connections = Network::drawConnections(model, _nb, _begin, _end, lambda, intensity, topology.uniform_uint64(), threads,
+                                            [&types](size_t i) {return TYPE_TRAITS[types[i]].factor;});
+    _spikes.assign((_nb + 63) / 64, 0);
+    _local.assign((_end - _begin + 63) / 64, 0);
+    _noise.assign(_end - _begin, 0.0);
+}
+
+void DistributedNetwork::update() {
+    const size_t n(_end - _begin);
+    Random::counter_normals(_noiseSeed, _begin, _step, n, _noise.data());
+    //same order of summation as the synchronous scan of the network
+    for (size_t i(0); i < n; i++) {
+        double input(0);
+        const int* sources(_connections.sources(i));
+        const double* weights(_connections.weights(i));
+        for (size_t k(0); k < _connections.degree(i); k++) {
+            if ((_spikes[sources[k] >> 6] >> (sources[k] & 63)) & 1) {
+                input += weights[k];
+            }
+        }
+        _neurons.setCurrent(i, _neurons.getW(i)*_noise[i] + input);
+    }
+    _neurons.update(0, n, _local.data());
+    _step += 1;
+}
+
+const std::vector<uint64_t>& DistributedNetwork::getLocalSpikes() const {
+    return _local;
+}
+
+const std::vector<uint64_t>& DistributedNetwork::getSpikes() const {
+    return _spikes;
+}
+
+void DistributedNetwork::setSpikes(const std::vector<uint64_t>& spikes) {
+    if (spikes.size() != _spikes.size()) {
+        throw std::domain_error("The spikes do not have one bit for each neuron of the network");
+    }
+    _spikes = spikes;
+}
+
+#ifdef USE_MPI
+void DistributedNetwork::exchange(MPI_Comm comm) {
+    //the words of each rank follow the ones of the previous rank, as its neurons
+    std::vector<int> counts(_ranks), displacements(_ranks);
+    for (size_t r(0); r < _ranks; r++) {
+        displacements[r] = first(_nb, r, _ranks) / 64;
+        counts[r] = (first(_nb, r + 1, _ranks) - first(_nb, r, _ranks) + 63) / 64;
+    }
+    std::copy(_local.begin(), _local.end(), _spikes.begin() + displacements[_rank]);
+    MPI_Allgatherv(MPI_IN_PLACE, 0, MPI_DATATYPE_NULL, _spikes.data(), counts.data(), displacements.data(), MPI_UINT64_T, comm);
+}
+#endif
+
+const NeuronPool& DistributedNetwork::getNeurons() const {
+    return _neurons;
+}
+
+const SynapseMatrix& DistributedNetwork::getCon() const {
+    return _connections;
+}
+
+size_t DistributedNetwork::getBegin() const {
+    return _begin;
+}
+
+size_t DistributedNetwork::getEnd() const {
+    return _end;
+}
+
+size_t DistributedNetwork::size() const {
+    return _nb;
+}
+
+size_t DistributedNetwork::getRank() const {
+    return _rank;
+}
+
+size_t DistributedNetwork::getRanks() const {
+    return _ranks;
+}
@@ -0,0 +1,139 @@
+#ifndef DISTRIBUTEDNETWORK_HPP
+#define DISTRIBUTEDNETWORK_HPP
+#include <vector>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include "neuronPool.hpp"
+#include "neuronTypes.hpp"
+#include "synapseMatrix.hpp"
+#include "constants.hpp"
+#include "random.hpp"
+#ifdef USE_MPI
+#include <mpi.h>
+#endif
+
+
+/**
+ * @brief The part of a network owned by one of several processes (ranks), which simulate the network together.
+ *
+ * The neurons are split in contiguous ranges of whole words of the spikes bitmask, one for each rank.
+ * A rank only stores the parameters and variables of its neurons, and the connections they receive (the rows of its neurons),
+ * the neurons of the other ranks being only seen through the spikes of the whole network, one bit per neuron.
+ * At each step, a rank updates its neurons from the spikes of the previous step by a synchronous scan,
+ * then the ranks exchange their new spikes (see \ref exchange), so that each one has again the spikes of the whole network.
+ *
+ * The neurons and the connections are the ones of a \ref Network built from the same generator with the parallel construction,
+ * and the noise is drawn from the same streams as its synchronous update (see \ref Network::setSynchronous):
+ * the spikes are the ones of the synchronous scan of this network, whatever the number of ranks.
+ */
+class DistributedNetwork {
+
+public:
+    /*! @brief First neuron of a rank
+     *  @param nb the number of neurons of the network
+     *  @param rank the index of the rank
+     *  @param ranks the number of ranks
+     *  @return the index of the first neuron of the rank, a multiple of 64, or nb for a rank without neurons
+     */
+    static size_t first(size_t nb, size_t rank, size_t ranks);
+
+    /*! @brief Number of neurons of each type when a proportion of them is excitatory, as laid out by \ref Network
+     *  @param nb the number of neurons
+     *  @param p_E the proportion of excitatory (RS) neurons, the others being FS neurons
+     *  @return the number of neurons of each type, in the order of \ref NeuronType
+     */
+    static std::array<int, NEURON_TYPES> typeCounts(int nb, double p_E);
+
+    /*! @brief Number of neurons of each type given their proportions, as laid out by \ref Network, RS being the rest of the neurons*/
+    static std::array<int, NEURON_TYPES> typeCounts(int nb, double p_FS, double p_IB, double p_RZ, double p_LTS, double p_TC, double p_CH);
+
+    /*! @brief Builds the neurons of a rank and the connections they receive.
+     *  The attributes of the neurons are drawn from the generator in the same order as by the constructors of \ref Network,
+     *  those of the neurons of the other ranks being drawn and dropped, and the connections are drawn as by its parallel construction
+     *  (see \ref Network::drawConnections), from the same substream.
+     *  @param rank the index of the rank
+     *  @param ranks the number of ranks
+     *  @param model the model of connection
+     *  @param counts the number of neurons of each type (see \ref typeCounts), laid out in the order of \ref NeuronType
+     *  @param intensity the mean intensity of connection
+     *  @param lambda the mean connectivity between neurons
+     *  @param delta the variability around 1 of the attributes of the neurons
+     *  @param noiseSeed the seed of the noise streams of the neurons
+     *  @param random the generator of the parameters and the connections
+     *  @param threads the number of threads drawing the connections
+     *  @note Throws a domain error if the rank is not one of the ranks
+     */
+    DistributedNetwork(size_t rank, size_t ranks, char model, const std::array<int, NEURON_TYPES>& counts, double intensity, double lambda,
+                       double delta, uint64_t noiseSeed, Random& random, size_t threads = _THREADS_);
+
+    /*! @brief Updates the neurons of the rank from the spikes of the previous step.
+     *  Their new spikes are given by \ref getLocalSpikes, and only replace the spikes of the network once exchanged.
+     */
+    void update();
+
+    /*! @brief Getter for the spikes of the neurons of the rank at the last update, bit i%64 of word i/64 being the neuron \ref getBegin + i*/
+    const std::vector<uint64_t>& getLocalSpikes() const;
+
+    /*! @brief Getter for the spikes of the whole network read by the next update, as \ref Network::getSpikes*/
+    const std::vector<uint64_t>& getSpikes() const;
+
+    /*! @brief Replaces the spikes of the whole network, gathered from the local spikes of all ranks
+     *  @note Throws a domain error if the bitmask does not have one bit per neuron of the network
+     */
+    void setSpikes(const std::vector<uint64_t>& spikes);
+
+#ifdef USE_MPI
+    /*! @brief Gathers the local spikes of all ranks of a communicator in the spikes of the whole network, each rank sending its words to all others
+     *  @param comm the communicator of the ranks, in the order of their indices
+     */
+    void exchange(MPI_Comm comm);
+#endif
+
+    /*! @brief Getter for the neurons of the rank, the neuron i of the pool being the neuron \ref getBegin + i of the network*/
+    const NeuronPool& getNeurons() const;
+
+    /*! @brief Getter for the connections received by the neurons of the rank, row i for the neuron \ref getBegin + i,
+     *  with the indices of the neurons in the whole network
+     */
+    const SynapseMatrix& getCon() const;
+
+    /*! @brief Index of the first neuron of the rank in the network*/
+    size_t getBegin() const;
+
+    /*! @brief Index following the last neuron of the rank in the network*/
+    size_t getEnd() const;
+
+    /*! @brief Number of neurons of the whole network*/
+    size_t size() const;
+
+    /*! @brief Index of the rank*/
+    size_t getRank() const;
+
+    /*! @brief Number of ranks*/
+    size_t getRanks() const;
+
+private:
+    ///index of the rank, and number of ranks
+    size_t _rank, _ranks;
+    ///number of neurons of the network
+    size_t _nb;
+    ///range of the neurons of the rank
+    size_t _begin, _end;
+    ///neurons of the rank
+    NeuronPool _neurons;
+    ///connections received by the neurons of the rank
+    SynapseMatrix _connections;
+    ///spikes of the whole network at the last exchange
+    std::vector<uint64_t> _spikes;
+    ///spikes of the neurons of the rank at the last update
+    std::vector<uint64_t> _local;
+    ///standard normal noise of the neurons of the rank for the current step
+    std::vector<double> _noise;
+    ///seed of the noise streams of the neurons
+    uint64_t _noiseSeed;
+    ///number of updates done, used as counter of the noise streams
+    uint64_t _step;
+};
+
+#endif //DISTRIBUTEDNETWORK_HPP
@@ -0,0 +1,113 @@
+#include "engine.hpp"
+#include <algorithm>
+#include <stdexcept>
+
+Engine::Engine(const EngineConfig& config, const Random& random)
+    : _random(random), _seed(random.getSeed()), _steps(0)
+{
+    if (config.neurons <= 0) throw std::domain_error("The number of neuron must be positive or greater than 0");
+    if (config.lambda < 0) throw std::domain_error("The mean connection between neurons must be positive and not exceed the number of neuron");
+    if (config.intensity <= 0) throw std::domain_error("The mean intensity of a connection must be positive and greater than 0");
+    if (config.threads <= 0) throw std::domain_error("The number of threads must be positive and greater than 0");
+    if (config.delta < 0 or config.delta > 1) throw std::domain_error("The value of delta should be between 0 and 1");
+    if (config.delays < 0) throw std::domain_error("The largest delay must be positive, or 0 for no delay");
+    //proportions in the order of the constructor of the network: FS, IB, RZ, LTS, TC, CH
+    const std::vector<std::string> names = {"FS", "IB", "RZ", "LTS", "TC", "CH"};
+    std::vector<double> proportions(names.size(), 0.0);
+    double sum(0);
+    for (const auto& type: config.types) {
+        const auto found(std::find(names.begin(), names.end(), type.first));
+        if (found == names.end() or type.second < 0) {
+            throw std::domain_error("The proportion of " + type.first + " neurons cannot be given, the types being FS, LTS, IB, RZ, TC and CH");
+        }
+        proportions[found - names.begin()] = type.second;
+        sum += type.second;
+    }
+    if (sum > 1 + 1e-10) throw std::domain_error("The sum of all proportions is greater than 1");
+    //the network is built as by neuron_network, from the streams of the seed
+    const Random root(random);
+    const double lambda(std::min(config.lambda, config.neurons - 1.0));
+    _random = root.substream(Random::PARAMETERS);
+    if (not config.snapshot.empty()) {
+        _net.reset(new Network(config.snapshot, _random));
+    }
+    else if (not config.types.empty()) {
+        _net.reset(new Network(config.model, config.neurons, proportions[0], proportions[1], proportions[2], proportions[3], proportions[4], proportions[5],
+                               config.intensity, lambda, config.delta, _random, config.construction, config.threads));
+    }
+    else {
+        _net.reset(new Network(config.model, config.neurons, config.excitatory, config.intensity, lambda, config.delta, _random,
+                               config.construction, config.threads));
+    }
+    _random = root.substream(Random::NOISE);
+    _net->setThreads(config.threads);
+    _net->setPropagation(config.propagation);
+    if (config.synchronous or config.precision != 'd') {
+        _net->setSynchronous(true);
+    }
+    if (config.delays > 0) {
+        _net->setDelays(config.delays, root.substream(Random::DELAYS).uniform_uint64());
+    }
+    _net->setPrecision(config.precision);
+}
+
+Engine::Engine(const EngineConfig& config, uint64_t seed)
+    : Engine(config, Random(seed))
+{}
+
+void Engine::step(int steps) {
+    for (int k(0); k < steps; k++) {
+        _net->update();
+        _steps += 1;
+        const Span<uint64_t> fired(spikes());
+        for (const auto& callback: _callbacks) {
+            callback(_steps, fired);
+        }
+    }
+}
+
+void Engine::onSpikes(const SpikeCallback& callback) {
+    _callbacks.push_back(callback);
+}
+
+uint64_t Engine::steps() const {
+    return _steps;
+}
+
+size_t Engine::size() const {
+    return _net->getNeurons().size();
+}
+
+uint64_t Engine::getSeed() const {
+    return _seed;
+}
+
+Span<uint64_t> Engine::spikes() const {
+    return Span<uint64_t>(_net->getSpikes().data(), _net->getSpikes().size());
+}
+
+Span<double> Engine::column(size_t index) const {
+    const NeuronPool& neurons(_net->getNeurons());
+    if (neurons.isSinglePrecision()) {
+        std::vector<double>& copy(_variables[index - 4]);
+        copy = neurons.column(index);
+        return Span<double>(copy.data(), copy.size());
+    }
+    return Span<double>(neurons.columns()[index], size());
+}
+
+Span<double> Engine::potentials() const {
+    return column(4);
+}
+
+Span<double> Engine::recoveries() const {
+    return column(5);
+}
+
+Span<double> Engine::currents() const {
+    return column(6);
+}
+
+const Network& Engine::network() const {
+    return *_net;
+}
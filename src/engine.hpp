@@ -0,0 +1,157 @@
+#ifndef ENGINE_HPP
+#define ENGINE_HPP
+#include <vector>
+#include <map>
+#include <string>
+#include <memory>
+#include <array>
+#include <functional>
+#include <cstddef>
+#include <cstdint>
+#include "network.hpp"
+#include "random.hpp"
+#include "constants.hpp"
+
+
+/**
+ * @brief Read-only view on contiguous elements owned by an \ref Engine, valid until its next step
+ */
+template<class T>
+class Span {
+
+public:
+    Span(const T* data, size_t size) : _data(data), _size(size) {}
+
+    /*! @brief First element*/
+    const T* data() const {return _data;};
+
+    /*! @brief Number of elements*/
+    size_t size() const {return _size;};
+
+    const T& operator[](size_t index) const {return _data[index];};
+    const T* begin() const {return _data;};
+    const T* end() const {return _data + _size;};
+
+private:
+    const T* _data;
+    size_t _size;
+};
+
+/**
+ * @brief Parameters of the network simulated by an \ref Engine, the ones of the options of neuron_network with the same defaults
+ */
+struct EngineConfig {
+    ///model of connection, 'b', 'c' or 'o' (-m)
+    char model = _MOD_;
+    ///number of neurons (-N)
+    int neurons = _NB_;
+    ///proportion of excitatory neurons (-p), used when no proportion of types is given
+    double excitatory = _PERC_;
+    ///proportions of the types FS, LTS, IB, RZ, TC and CH (-T), the other neurons being RS, for instance {{"FS", 0.2}, {"CH", 0.1}}
+    std::map<std::string, double> types;
+    ///mean intensity of a connection (-L)
+    double intensity = _INT_;
+    ///mean connectivity between the neurons (-l), at most the number of neurons minus 1
+    double lambda = _LAMB_;
+    ///variability around 1 of the attributes of the neurons (-d)
+    double delta = _DEL_;
+    ///construction of the connections, 's' for sequential or 'p' for parallel (-C)
+    char construction = _CONSTRUCTION_;
+    ///number of threads building and updating the network (-j)
+    int threads = _THREADS_;
+    ///snapshot written by \ref Network::save from which the network is loaded instead of being built (-R), empty for none
+    std::string snapshot;
+    ///propagation of the spikes, 's' for scan or 'e' for events (-P)
+    char propagation = _PROP_;
+    ///true for all neurons to read the spikes of the previous step (-S)
+    bool synchronous = false;
+    ///largest transmission delay in steps, 0 for none (-D)
+    int delays = _DELAY_;
+    ///precision of the synaptic weights and of the state of the neurons read by the update, 'd', 'f' or 'h' (-Q)
+    char precision = _PRECISION_;
+};
+
+/**
+ * @brief Simulation of a network driven by another program, without the command line nor the output files of neuron_network.
+ *
+ * The network is built from a \ref EngineConfig and from a generator given to the engine, as neuron_network does from its seed:
+ * an engine and neuron_network given the same parameters and seed simulate the same spikes.
+ * The program steps the network, reads its spikes and the variables of its neurons in place through \ref Span
+ * (or a copy in double when the state is stored in float, see \ref EngineConfig::precision), and can be called back with the spikes of each step.
+ */
+class Engine {
+
+public:
+    ///function called with the index of each step, starting at 1, and the bitmask of the neurons which fired (see \ref Network::getSpikes)
+    typedef std::function<void(uint64_t step, const Span<uint64_t>& spikes)> SpikeCallback;
+
+    /*! @brief Builds the network, then prepares its update
+     *  @param config the parameters of the network
+     *  @param random the generator of the simulation, whose streams (see \ref Random::substream) give the parameters, the connections,
+     *  the noise and the delays; the engine draws from its own copy
+     *  @note Throws a domain error if a parameter is not valid
+     */
+    Engine(const EngineConfig& config, const Random& random);
+
+    /*! @brief Builds the network from a seed, as neuron_network -s
+     *  @param config the parameters of the network
+     *  @param seed the seed of the generator, 0 for a seed drawn from the random device
+     */
+    explicit Engine(const EngineConfig& config, uint64_t seed = 0);
+
+    Engine(const Engine&) = delete;
+    Engine& operator=(const Engine&) = delete;
+
+    /*! @brief Updates the network, then calls the callbacks with its spikes, for each step
+     *  @param steps the number of steps
+     */
+    void step(int steps = 1);
+
+    /*! @brief Registers a function called after each step
+     *  @param callback the function, called in the order of the registrations
+     */
+    void onSpikes(const SpikeCallback& callback);
+
+    /*! @brief Number of steps done*/
+    uint64_t steps() const;
+
+    /*! @brief Number of neurons of the network*/
+    size_t size() const;
+
+    /*! @brief Seed of the generator, which reproduces the simulation*/
+    uint64_t getSeed() const;
+
+    /*! @brief Spikes of the last step, bit i%64 of word i/64 being the neuron i*/
+    Span<uint64_t> spikes() const;
+
+    /*! @brief Membrane potentials v of the neurons*/
+    Span<double> potentials() const;
+
+    /*! @brief Recovery variables u of the neurons*/
+    Span<double> recoveries() const;
+
+    /*! @brief Input currents of the neurons at the last step*/
+    Span<double> currents() const;
+
+    /*! @brief The network simulated, for instance to read its connections*/
+    const Network& network() const;
+
+private:
+    /*! @brief One of the arrays v, u and current of the pool of neurons (see \ref NeuronPool::columns), copied in double in single precision*/
+    Span<double> column(size_t index) const;
+
+    ///generator of the network, drawing the noise once it is built
+    Random _random;
+    ///seed of the simulation
+    uint64_t _seed;
+    ///network simulated
+    std::unique_ptr<Network> _net;
+    ///v, u and current copied in double when the state of the neurons is stored in float
+    mutable std::array<std::vector<double>, 3> _variables;
+    ///functions called after each step
+    std::vector<SpikeCallback> _callbacks;
+    ///number of steps done
+    uint64_t _steps;
+};
+
+#endif //ENGINE_HPP
@@ -5,7 +5,7 @@
 /**
  * @brief An ExcitatoryNeuron class.
  * 
- * A type of neuron inheriting from the pure virtual class Neuron.
+ * A type of neuron inheriting from the class Neuron.
  */
 class ExcitatoryNeuron :public Neuron
 {
@@ -13,32 +13,20 @@ class ExcitatoryNeuron :public Neuron
     /**
      * @brief Construct a new Excitatory Neuron object
      * 
-     * @param delta The delta of uniform distribution determining the noise 
+     * @param delta The delta of uniform distribution determining the noise
+     * @param random The generator from which the attributes are drawn 
      * @param type A string containing the type of excitatory neuron 
+     * @param pool The pool in which the neuron is stored, by default the neuron has a pool of its own
      * 
      * @note type has a default parameter "RS"
      */
-    ExcitatoryNeuron(double delta, std::string type = "RS");
+    ExcitatoryNeuron(double delta, Random& random, std::string type = "RS", NeuronPool* pool = nullptr);
 
     /**
      * @brief Destroy the Excitatory Neuron object
      */
     virtual ~ExcitatoryNeuron() override;
 
-    /**
-     * @brief A getter for the W of the Neuron
-     * 
-     * @return the W of the Excitatory Neuron
-     */   
-    virtual double getW() const override;
-
-    /**
-     * @brief A getter for the factor of the Neuron
-
-     * @return the factor of the Excitatory Neuron
-     */
-    virtual double factor() const override;
-
 };
 
 #endif //EXCITATORYNEURON_HPP
\ No newline at end of file
@@ -5,29 +5,22 @@
 #include <iostream>
 
 
-InhibitoryNeuron::InhibitoryNeuron(double delta, std::string type)
-:Neuron(type)
+InhibitoryNeuron::InhibitoryNeuron(double delta, Random& random, std::string type, NeuronPool* pool)
+:Neuron(type, _INHIB_W_, _INHIB_FACTOR_, pool)
 {
     try {
         double lowerbound(1 - delta);
         double upperbound(1 + delta);
-        if (type == "LTS") {
-            _a = _LTS_A_*_RNG->uniform_double(lowerbound, upperbound);
-            _b = _LTS_B_*_RNG->uniform_double(lowerbound, upperbound);
-            _c = _LTS_C_*_RNG->uniform_double(lowerbound, upperbound);
-            _d = _LTS_D_*_RNG->uniform_double(lowerbound, upperbound);
-            }
-        else if (type == "FS") {
-            _a = _FS_A_*_RNG->uniform_double(lowerbound, upperbound);
-            _b = _FS_B_*_RNG->uniform_double(lowerbound, upperbound);
-            _c = _FS_C_*_RNG->uniform_double(lowerbound, upperbound);
-            _d = _FS_D_*_RNG->uniform_double(lowerbound, upperbound);
-        }
-        else {
+        //the attributes are drawn around the nominal ones of the type, in the order a, b, c, d
+        const TypeTraits& traits(typeTraits(_pool->typeOf(_index)));
+        if (traits.excitatory) {
            throw std::domain_error("The Inhibitory " + type + " neuron does not exist");
         }
-        _v = _INIT_V_;
-        _u = _b*_v;
+        double a(traits.a*random.uniform_double(lowerbound, upperbound));
+        double b(traits.b*random.uniform_double(lowerbound, upperbound));
+        double c(traits.c*random.uniform_double(lowerbound, upperbound));
+        double d(traits.d*random.uniform_double(lowerbound, upperbound));
+        _pool->setAttributs(_index, a, b, c, d);
     } catch(const std::exception& e) {
             std::cerr << e.what() << '\n';
             throw e.what();
@@ -36,10 +29,3 @@ InhibitoryNeuron::InhibitoryNeuron(double delta, std::string type)
 
 InhibitoryNeuron::~InhibitoryNeuron()
 {}
-
-double InhibitoryNeuron::getW() const {
-    return _INHIB_W_;
-}
-double InhibitoryNeuron::factor() const {
-    return _INHIB_FACTOR_;
-}
\ No newline at end of file
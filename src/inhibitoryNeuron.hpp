@@ -5,7 +5,7 @@
 /**
  * @brief An InhibitoryNeuron class.
  * 
- * A type of neuron inheriting from the pure virtual class Neuron.
+ * A type of neuron inheriting from the class Neuron.
  */
 class InhibitoryNeuron :public Neuron
 {
@@ -14,10 +14,12 @@ class InhibitoryNeuron :public Neuron
      * @brief Construct a new Inhibitory Neuron object
      * 
      * @param delta The delta of uniform distribution determining the noise
+     * @param random The generator from which the attributes are drawn
      * @param type A string containing the type of inhibitory neuron 
+     * @param pool The pool in which the neuron is stored, by default the neuron has a pool of its own
      * @note type has a default parameter "FS"
      */
-    InhibitoryNeuron(double delta, std::string type = "FS");
+    InhibitoryNeuron(double delta, Random& random, std::string type = "FS", NeuronPool* pool = nullptr);
 
     /**
      * @brief Destroy the Inhibitory Neuron object
@@ -25,21 +27,6 @@ class InhibitoryNeuron :public Neuron
      */
     virtual ~InhibitoryNeuron() override;
 
-    /**
-     * @brief A getter for the W of the Neuron
-     * 
-     * @return the W of the Inhibitory Neuron
-     */
-
-    virtual double getW() const override;
-
-    /**
-     * @brief A getter for the factor of the Neuron
-     * 
-     * @return the factor of the Neuron
-     */
-    virtual double factor() const override;
-
 };
 
 #endif //INHIBITORYNEURON_HPP
\ No newline at end of file
@@ -0,0 +1,246 @@
+#include "kernels.hpp"
+#include <algorithm>
+#include <stdexcept>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define KERNELS_X86
+#include <immintrin.h>
+#endif
+
+namespace {
+
+template<class T>
+void integrateScalar(size_t n, const T* a, const T* b, const T* c, const T* d, T* v, T* u, const T* current, uint64_t* spikes) {
+    for (size_t start(0); start < n; start += 64) {
+        const size_t count(std::min<size_t>(64, n - start));
+        uint64_t bits(0);
+        for (size_t k(0); k < count; ++k) {
+            const size_t i(start + k);
+            bits |= uint64_t(integrateNeuron(a[i], b[i], c[i], d[i], v[i], u[i], current[i])) << k;
+        }
+        spikes[start / 64] = bits;
+    }
+}
+
+#ifdef KERNELS_X86
+
+__attribute__((target("avx2")))
+void integrateAVX2(size_t n, const double* a, const double* b, const double* c, const double* d,
+                   double* v, double* u, const double* current, uint64_t* spikes) {
+    const __m256d threshold(_mm256_set1_pd(_DISCHARGE_T_));
+    const __m256d quadratic(_mm256_set1_pd(0.04));
+    const __m256d linear(_mm256_set1_pd(5));
+    const __m256d constant(_mm256_set1_pd(140));
+    const __m256d half(_mm256_set1_pd(0.5));
+    for (size_t start(0); start < n; start += 64) {
+        const size_t count(std::min<size_t>(64, n - start));
+        uint64_t bits(0);
+        size_t k(0);
+        for (; k + 4 <= count; k += 4) {
+            const size_t i(start + k);
+            const __m256d v0(_mm256_loadu_pd(v + i));
+            const __m256d u0(_mm256_loadu_pd(u + i));
+            const __m256d input(_mm256_loadu_pd(current + i));
+            const __m256d firing(_mm256_cmp_pd(v0, threshold, _CMP_GE_OQ));
+            //same operations, in the same order, as integrateNeuron
+            __m256d dv(_mm256_add_pd(_mm256_mul_pd(_mm256_mul_pd(quadratic, v0), v0), _mm256_mul_pd(linear, v0)));
+            dv = _mm256_add_pd(_mm256_sub_pd(_mm256_add_pd(dv, constant), u0), input);
+            __m256d v1(_mm256_add_pd(v0, _mm256_mul_pd(half, dv)));
+            dv = _mm256_add_pd(_mm256_mul_pd(_mm256_mul_pd(quadratic, v1), v1), _mm256_mul_pd(linear, v1));
+            dv = _mm256_add_pd(_mm256_sub_pd(_mm256_add_pd(dv, constant), u0), input);
+            v1 = _mm256_add_pd(v1, _mm256_mul_pd(half, dv));
+            __m256d u1(_mm256_add_pd(u0, _mm256_mul_pd(_mm256_loadu_pd(a + i),
+                                                          _mm256_sub_pd(_mm256_mul_pd(_mm256_loadu_pd(b + i), v1), u0))));
+            v1 = _mm256_blendv_pd(v1, threshold, _mm256_cmp_pd(v1, threshold, _CMP_GT_OQ));
+            //masked reset of the neurons which were firing
+            v1 = _mm256_blendv_pd(v1, _mm256_loadu_pd(c + i), firing);
+            u1 = _mm256_blendv_pd(u1, _mm256_add_pd(u0, _mm256_loadu_pd(d + i)), firing);
+            _mm256_storeu_pd(v + i, v1);
+            _mm256_storeu_pd(u + i, u1);
+            bits |= uint64_t(_mm256_movemask_pd(_mm256_cmp_pd(v1, threshold, _CMP_GE_OQ))) << k;
+        }
+        for (; k < count; ++k) {
+            const size_t i(start + k);
+            bits |= uint64_t(integrateNeuron(a[i], b[i], c[i], d[i], v[i], u[i], current[i])) << k;
+        }
+        spikes[start / 64] = bits;
+    }
+}
+
+__attribute__((target("avx2")))
+void integrateAVX2(size_t n, const float* a, const float* b, const float* c, const float* d,
+                   float* v, float* u, const float* current, uint64_t* spikes) {
+    const __m256 threshold(_mm256_set1_ps(_DISCHARGE_T_));
+    const __m256 quadratic(_mm256_set1_ps(0.04f));
+    const __m256 linear(_mm256_set1_ps(5));
+    const __m256 constant(_mm256_set1_ps(140));
+    const __m256 half(_mm256_set1_ps(0.5f));
+    for (size_t start(0); start < n; start += 64) {
+        const size_t count(std::min<size_t>(64, n - start));
+        uint64_t bits(0);
+        size_t k(0);
+        for (; k + 8 <= count; k += 8) {
+            const size_t i(start + k);
+            const __m256 v0(_mm256_loadu_ps(v + i));
+            const __m256 u0(_mm256_loadu_ps(u + i));
+            const __m256 input(_mm256_loadu_ps(current + i));
+            const __m256 firing(_mm256_cmp_ps(v0, threshold, _CMP_GE_OQ));
+            //same operations, in the same order, as integrateNeuron
+            __m256 dv(_mm256_add_ps(_mm256_mul_ps(_mm256_mul_ps(quadratic, v0), v0), _mm256_mul_ps(linear, v0)));
+            dv = _mm256_add_ps(_mm256_sub_ps(_mm256_add_ps(dv, constant), u0), input);
+            __m256 v1(_mm256_add_ps(v0, _mm256_mul_ps(half, dv)));
+            dv = _mm256_add_ps(_mm256_mul_ps(_mm256_mul_ps(quadratic, v1), v1), _mm256_mul_ps(linear, v1));
+            dv = _mm256_add_ps(_mm256_sub_ps(_mm256_add_ps(dv, constant), u0), input);
+            v1 = _mm256_add_ps(v1, _mm256_mul_ps(half, dv));
+            __m256 u1(_mm256_add_ps(u0, _mm256_mul_ps(_mm256_loadu_ps(a + i),
+                                                       _mm256_sub_ps(_mm256_mul_ps(_mm256_loadu_ps(b + i), v1), u0))));
+            v1 = _mm256_blendv_ps(v1, threshold, _mm256_cmp_ps(v1, threshold, _CMP_GT_OQ));
+            //masked reset of the neurons which were firing
+            v1 = _mm256_blendv_ps(v1, _mm256_loadu_ps(c + i), firing);
+            u1 = _mm256_blendv_ps(u1, _mm256_add_ps(u0, _mm256_loadu_ps(d + i)), firing);
+            _mm256_storeu_ps(v + i, v1);
+            _mm256_storeu_ps(u + i, u1);
+            bits |= uint64_t(_mm256_movemask_ps(_mm256_cmp_ps(v1, threshold, _CMP_GE_OQ))) << k;
+        }
+        for (; k < count; ++k) {
+            const size_t i(start + k);
+            bits |= uint64_t(integrateNeuron(a[i], b[i], c[i], d[i], v[i], u[i], current[i])) << k;
+        }
+        spikes[start / 64] = bits;
+    }
+}
+
+__attribute__((target("avx512f")))
+void integrateAVX512(size_t n, const double* a, const double* b, const double* c, const double* d,
+                     double* v, double* u, const double* current, uint64_t* spikes) {
+    const __m512d threshold(_mm512_set1_pd(_DISCHARGE_T_));
+    const __m512d quadratic(_mm512_set1_pd(0.04));
+    const __m512d linear(_mm512_set1_pd(5));
+    const __m512d constant(_mm512_set1_pd(140));
+    const __m512d half(_mm512_set1_pd(0.5));
+    for (size_t start(0); start < n; start += 64) {
+        const size_t count(std::min<size_t>(64, n - start));
+        uint64_t bits(0);
+        size_t k(0);
+        for (; k + 8 <= count; k += 8) {
+            const size_t i(start + k);
+            const __m512d v0(_mm512_loadu_pd(v + i));
+            const __m512d u0(_mm512_loadu_pd(u + i));
+            const __m512d input(_mm512_loadu_pd(current + i));
+            const __mmask8 firing(_mm512_cmp_pd_mask(v0, threshold, _CMP_GE_OQ));
+            //same operations, in the same order, as integrateNeuron
+            __m512d dv(_mm512_add_pd(_mm512_mul_pd(_mm512_mul_pd(quadratic, v0), v0), _mm512_mul_pd(linear, v0)));
+            dv = _mm512_add_pd(_mm512_sub_pd(_mm512_add_pd(dv, constant), u0), input);
+            __m512d v1(_mm512_add_pd(v0, _mm512_mul_pd(half, dv)));
+            dv = _mm512_add_pd(_mm512_mul_pd(_mm512_mul_pd(quadratic, v1), v1), _mm512_mul_pd(linear, v1));
+            dv = _mm512_add_pd(_mm512_sub_pd(_mm512_add_pd(dv, constant), u0), input);
+            v1 = _mm512_add_pd(v1, _mm512_mul_pd(half, dv));
+            __m512d u1(_mm512_add_pd(u0, _mm512_mul_pd(_mm512_loadu_pd(a + i),
+                                                          _mm512_sub_pd(_mm512_mul_pd(_mm512_loadu_pd(b + i), v1), u0))));
+            v1 = _mm512_mask_blend_pd(_mm512_cmp_pd_mask(v1, threshold, _CMP_GT_OQ), v1, threshold);
+            //masked reset of the neurons which were firing
+            v1 = _mm512_mask_blend_pd(firing, v1, _mm512_loadu_pd(c + i));
+            u1 = _mm512_mask_blend_pd(firing, u1, _mm512_add_pd(u0, _mm512_loadu_pd(d + i)));
+            _mm512_storeu_pd(v + i, v1);
+            _mm512_storeu_pd(u + i, u1);
+            bits |= uint64_t(_mm512_cmp_pd_mask(v1, threshold, _CMP_GE_OQ)) << k;
+        }
+        for (; k < count; ++k) {
+            const size_t i(start + k);
+            bits |= uint64_t(integrateNeuron(a[i], b[i], c[i], d[i], v[i], u[i], current[i])) << k;
+        }
+        spikes[start / 64] = bits;
+    }
+}
+
+__attribute__((target("avx512f")))
+void integrateAVX512(size_t n, const float* a, const float* b, const float* c, const float* d,
+                     float* v, float* u, const float* current, uint64_t* spikes) {
+    const __m512 threshold(_mm512_set1_ps(_DISCHARGE_T_));
+    const __m512 quadratic(_mm512_set1_ps(0.04f));
+    const __m512 linear(_mm512_set1_ps(5));
+    const __m512 constant(_mm512_set1_ps(140));
+    const __m512 half(_mm512_set1_ps(0.5f));
+    for (size_t start(0); start < n; start += 64) {
+        const size_t count(std::min<size_t>(64, n - start));
+        uint64_t bits(0);
+        size_t k(0);
+        for (; k + 16 <= count; k += 16) {
+            const size_t i(start + k);
+            const __m512 v0(_mm512_loadu_ps(v + i));
+            const __m512 u0(_mm512_loadu_ps(u + i));
+            const __m512 input(_mm512_loadu_ps(current + i));
+            const __mmask16 firing(_mm512_cmp_ps_mask(v0, threshold, _CMP_GE_OQ));
+            //same operations, in the same order, as integrateNeuron
+            __m512 dv(_mm512_add_ps(_mm512_mul_ps(_mm512_mul_ps(quadratic, v0), v0), _mm512_mul_ps(linear, v0)));
+            dv = _mm512_add_ps(_mm512_sub_ps(_mm512_add_ps(dv, constant), u0), input);
+            __m512 v1(_mm512_add_ps(v0, _mm512_mul_ps(half, dv)));
+            dv = _mm512_add_ps(_mm512_mul_ps(_mm512_mul_ps(quadratic, v1), v1), _mm512_mul_ps(linear, v1));
+            dv = _mm512_add_ps(_mm512_sub_ps(_mm512_add_ps(dv, constant), u0), input);
+            v1 = _mm512_add_ps(v1, _mm512_mul_ps(half, dv));
+            __m512 u1(_mm512_add_ps(u0, _mm512_mul_ps(_mm512_loadu_ps(a + i),
+                                                       _mm512_sub_ps(_mm512_mul_ps(_mm512_loadu_ps(b + i), v1), u0))));
+            v1 = _mm512_mask_blend_ps(_mm512_cmp_ps_mask(v1, threshold, _CMP_GT_OQ), v1, threshold);
+            //masked reset of the neurons which were firing
+            v1 = _mm512_mask_blend_ps(firing, v1, _mm512_loadu_ps(c + i));
+            u1 = _mm512_mask_blend_ps(firing, u1, _mm512_add_ps(u0, _mm512_loadu_ps(d + i)));
+            _mm512_storeu_ps(v + i, v1);
+            _mm512_storeu_ps(u + i, u1);
+            bits |= uint64_t(_mm512_cmp_ps_mask(v1, threshold, _CMP_GE_OQ)) << k;
+        }
+        for (; k < count; ++k) {
+            const size_t i(start + k);
+            bits |= uint64_t(integrateNeuron(a[i], b[i], c[i], d[i], v[i], u[i], current[i])) << k;
+        }
+        spikes[start / 64] = bits;
+    }
+}
+
+#endif //KERNELS_X86
+
+}
+
+std::vector<std::string> availableKernels() {
+    std::vector<std::string> kernels;
+#ifdef KERNELS_X86
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx512f")) {
+        kernels.push_back("avx512");
+    }
+    if (__builtin_cpu_supports("avx2")) {
+        kernels.push_back("avx2");
+    }
+#endif
+    kernels.push_back("scalar");
+    return kernels;
+}
+
+IntegrationKernel integrationKernel(const std::string& name) {
+    if (name.empty()) {
+        static const IntegrationKernel fastest(integrationKernel(availableKernels().front()));
+        return fastest;
+    }
+    const std::vector<std::string> kernels(availableKernels());
+    if (std::find(kernels.begin(), kernels.end(), name) == kernels.end()) {
+        throw std::domain_error("The " + name + " kernel cannot run on this processor");
+    }
+#ifdef KERNELS_X86
+    if (name == "avx512") return integrateAVX512;
+    if (name == "avx2") return integrateAVX2;
+#endif
+    return integrateScalar;
+}
+
+IntegrationKernel32 integrationKernel32(const std::string& name) {
+    if (name.empty()) {
+        static const IntegrationKernel32 fastest(integrationKernel32(availableKernels().front()));
+        return fastest;
+    }
+    //same names and availability as the kernels of a state in double
+    integrationKernel(name);
+#ifdef KERNELS_X86
+    if (name == "avx512") return integrateAVX512;
+    if (name == "avx2") return integrateAVX2;
+#endif
+    return integrateScalar;
+}
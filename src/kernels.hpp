@@ -0,0 +1,74 @@
+#ifndef KERNELS_HPP
+#define KERNELS_HPP
+#include <vector>
+#include <string>
+#include <cstddef>
+#include <cstdint>
+#include "constants.hpp"
+
+
+/**
+ * @brief Integrates one neuron for 1 simulation step (Izhikevich model).
+ *
+ * A neuron which reached the threshold is reset, otherwise v is updated twice and u once,
+ * v being brought back to the threshold when it passes it.
+ * All kernels follow exactly this sequence of operations, so that they give the same results.
+ * @tparam T double, or float for a state in single precision, in which all operations are done
+ * @param a,b,c,d the attributes of the neuron
+ * @param v,u the variables of the neuron, updated
+ * @param current the synaptic current of the neuron
+ * @return true if the neuron fires after the update
+ */
+template<class T>
+inline bool integrateNeuron(T a, T b, T c, T d, T& v, T& u, T current) {
+    if (v >= _DISCHARGE_T_) {
+        v = c;
+        u += d;
+    }
+    else {
+        //based on Izhikevich model, we have to udpate the v twice more often than the u.
+        v += (T(0.5)*(T(0.04)*v*v + 5*v + 140 - u + current));
+        v += (T(0.5)*(T(0.04)*v*v + 5*v + 140 - u + current));
+        u += (a*(b*v - u));
+        if (v > _DISCHARGE_T_) {
+            v = _DISCHARGE_T_;
+        }
+    }
+    return v >= _DISCHARGE_T_;
+}
+
+/**
+ * @brief A kernel integrating n consecutive neurons for 1 simulation step.
+ *
+ * The arguments are the arrays of attributes a, b, c, d, of variables v, u (updated) and of currents of the neurons,
+ * and the bitmask in which the firing state of each neuron after the update is written
+ * (bit k%64 of word k/64 for the k-th neuron, the bits after the n-th one being cleared).
+ */
+typedef void (*IntegrationKernel)(size_t n, const double* a, const double* b, const double* c, const double* d,
+                                  double* v, double* u, const double* current, uint64_t* spikes);
+
+/**
+ * @brief A kernel integrating n consecutive neurons whose state is stored in float, as \ref IntegrationKernel, twice as many at once.
+ */
+typedef void (*IntegrationKernel32)(size_t n, const float* a, const float* b, const float* c, const float* d,
+                                    float* v, float* u, const float* current, uint64_t* spikes);
+
+/**
+ * @brief Names of the kernels which can run on this processor, the fastest one first.
+ * @return a list among "avx512", "avx2" and "scalar" (always available)
+ */
+std::vector<std::string> availableKernels();
+
+/**
+ * @brief Gives a kernel by its name
+ * @param name a name returned by \ref availableKernels, or an empty string for the fastest kernel
+ * @note Throws a domain error if the kernel cannot run on this processor
+ */
+IntegrationKernel integrationKernel(const std::string& name = "");
+
+/**
+ * @brief Gives a kernel for a state in float by its name, as \ref integrationKernel
+ */
+IntegrationKernel32 integrationKernel32(const std::string& name = "");
+
+#endif //KERNELS_HPP
@@ -1,17 +1,37 @@
 #include <iostream>
 #include "random.hpp"
 #include "simulation.hpp"
+#include "profiler.hpp"
 #include <stdexcept>
+#ifdef USE_MPI
+#include <mpi.h>
+#endif
 
 Random* _RNG = new Random();
 
 int main(int argc, char** argv){
+#ifdef USE_MPI
+    MPI_Init(&argc, &argv);
+#endif
+    int status(0);
     try {
         Simulation sim(argc, argv);
         sim.run();
+        if (Profiler::instance().enabled()) {
+            Profiler::instance().report(std::cerr);
+        }
         if (_RNG) delete _RNG;
     } catch (const std::exception &e) {
-        return 1;
+        status = 1;
     }
-    return 0;
-}
\ No newline at end of file
+#ifdef USE_MPI
+    int ranks(1);
+    MPI_Comm_size(MPI_COMM_WORLD, &ranks);
+    if (status != 0 and ranks > 1) {
+        //the other ranks may be waiting for the spikes of this one
+        MPI_Abort(MPI_COMM_WORLD, status);
+    }
+    MPI_Finalize();
+#endif
+    return status;
+}
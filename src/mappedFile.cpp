@@ -0,0 +1,54 @@
+#include "mappedFile.hpp"
+#include <fstream>
+#include <stdexcept>
+
+#if defined(__unix__) || defined(__APPLE__)
+#define MAPPEDFILE_MMAP
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+MappedFile::MappedFile(const std::string& filename)
+    : _data(nullptr), _size(0)
+{
+#ifdef MAPPEDFILE_MMAP
+    int descriptor(open(filename.c_str(), O_RDONLY));
+    struct stat status;
+    if (descriptor < 0 or fstat(descriptor, &status) != 0) {
+        if (descriptor >= 0) close(descriptor);
+        throw std::runtime_error("The file " + filename + " cannot be opened");
+    }
+    _size = status.st_size;
+    if (_size > 0) {
+        void* mapping(mmap(nullptr, _size, PROT_READ, MAP_PRIVATE, descriptor, 0));
+        if (mapping == MAP_FAILED) {
+            close(descriptor);
+            throw std::runtime_error("The file " + filename + " cannot be mapped in memory");
+        }
+        _data = static_cast<const char*>(mapping);
+    }
+    //the mapping stays valid once the file is closed
+    close(descriptor);
+#else
+    std::ifstream in(filename, std::ios::in | std::ios::binary | std::ios::ate);
+    if (not in.is_open()) {
+        throw std::runtime_error("The file " + filename + " cannot be opened");
+    }
+    _size = in.tellg();
+    //doubles, so that the copy is aligned as a mapping would be
+    _copy.resize((_size + sizeof(double) - 1) / sizeof(double));
+    in.seekg(0);
+    in.read(reinterpret_cast<char*>(_copy.data()), _size);
+    _data = reinterpret_cast<const char*>(_copy.data());
+#endif
+}
+
+MappedFile::~MappedFile() {
+#ifdef MAPPEDFILE_MMAP
+    if (_data != nullptr) {
+        munmap(const_cast<char*>(_data), _size);
+    }
+#endif
+}
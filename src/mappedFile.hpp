@@ -0,0 +1,42 @@
+#ifndef MAPPEDFILE_HPP
+#define MAPPEDFILE_HPP
+#include <string>
+#include <vector>
+#include <cstddef>
+
+
+/**
+ * @brief Read-only content of a file, mapped in memory.
+ *
+ * The pages of the file are only read from the disk when they are accessed, and are shared
+ * by the processes mapping the same file. On systems without mmap, the file is read in memory instead.
+ */
+class MappedFile {
+
+public:
+    /*! @brief Maps a whole file
+     *  @param filename the name of the file
+     *  @note Throws a runtime error if the file cannot be opened
+     */
+    MappedFile(const std::string& filename);
+
+    /*! @brief Unmaps the file*/
+    ~MappedFile();
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    /*! @brief First byte of the file, aligned on a memory page*/
+    const char* data() const {return _data;};
+
+    /*! @brief Size of the file in bytes*/
+    size_t size() const {return _size;};
+
+private:
+    const char* _data;
+    size_t _size;
+    ///content of the file when it cannot be mapped
+    std::vector<double> _copy;
+};
+
+#endif //MAPPEDFILE_HPP
@@ -1,75 +1,440 @@
 #include "network.hpp"
 #include "inhibitoryNeuron.hpp"
 #include "excitatoryNeuron.hpp"
+#include "constants.hpp"
 #include <algorithm>
+#include <cmath>
+#include <numeric>
+#include <random>
+#include <stdexcept>
+#include <utility>
+#include "threadPool.hpp"
+#include "profiler.hpp"
+#include "mappedFile.hpp"
+#include <cstring>
+#include <fstream>
 
-Network::Network(char model, int nb, double p_E, double intensity, double lambda, double delta)
-    : _intensity(intensity), _model(model)
+namespace {
+
+const char SNAPSHOT_MAGIC[8] = {'I', 'Z', 'N', 'E', 'T', 'W', 'R', 'K'};
+const uint32_t SNAPSHOT_VERSION(2);
+const uint32_t BYTE_ORDER_MARK(0x01020304);
+//size of the header, and alignment of each array of a snapshot
+const size_t SNAPSHOT_ALIGN(64);
+
+size_t aligned(size_t bytes) {
+    return (bytes + SNAPSHOT_ALIGN - 1) / SNAPSHOT_ALIGN * SNAPSHOT_ALIGN;
+}
+
+void writeArray(std::ostream& out, const void* data, size_t bytes) {
+    static const char padding[SNAPSHOT_ALIGN] = {0};
+    out.write(static_cast<const char*>(data), bytes);
+    out.write(padding, aligned(bytes) - bytes);
+}
+
+}
+
+Network::Network(char model, int nb, double p_E, double intensity, double lambda, double delta, Random& random, char construction, size_t threads)
+    : _random(&random), _intensity(intensity), _scale(1), _model(model), _propagation(_PROP_), _synchronous(false), _noiseSeed(0), _step(0), _maxDelay(0), _delaySeed(0), _precision('d'), _weightError(0), _neuronsforoutputs()
 {
     Neuron* neuron;
+    _neurons.reserve(nb);
     int excit(p_E * nb);
     for (int i(0); i < nb - excit; ++i) {
-        neuron = new InhibitoryNeuron(delta);
+        neuron = new InhibitoryNeuron(delta, *_random, "FS", &_neurons);
         _network.push_back(neuron);
         _neuronsforoutputs[0] = neuron;
     }
     for (int i(0); i < excit; ++i) {
-        neuron = new ExcitatoryNeuron(delta);
+        neuron = new ExcitatoryNeuron(delta, *_random, "RS", &_neurons);
         _network.push_back(neuron);
         _neuronsforoutputs[6] = neuron;
     }
-    makeConnections(lambda);
+    connect(lambda, construction, threads);
+    makeBlocks();
+    resetSpikes();
 }
 
-Network::Network(char model, int nb, double p_FS, double p_IB, double p_RZ, double p_LTS, double p_TC, double p_CH, double intensity, double lambda, double delta)
-        : _intensity(intensity), _model(model)
+Network::Network(char model, int nb, double p_FS, double p_IB, double p_RZ, double p_LTS, double p_TC, double p_CH, double intensity, double lambda, double delta,
+                 Random& random, char construction, size_t threads)
+        : _random(&random), _intensity(intensity), _scale(1), _model(model), _propagation(_PROP_), _synchronous(false), _noiseSeed(0), _step(0), _maxDelay(0), _delaySeed(0), _precision('d'), _weightError(0), _neuronsforoutputs()
 {
     Neuron* neuron;
+    _neurons.reserve(nb);
     std::vector<std::string> type = {"FS", "LTS", "IB", "RZ", "TC", "CH", "RS"};
     int fs(nb*p_FS);
     for (int i(0); i < fs; i++) {
-        neuron = new InhibitoryNeuron(delta, type[0]);
+        neuron = new InhibitoryNeuron(delta, *_random, type[0], &_neurons);
         _network.push_back(neuron);
         _neuronsforoutputs[0] = neuron;
     }
     int lts(nb*p_LTS);
     for (int i(0); i < lts; i++) {
-        neuron = new InhibitoryNeuron(delta, type[1]);
+        neuron = new InhibitoryNeuron(delta, *_random, type[1], &_neurons);
         _network.push_back(neuron);
         _neuronsforoutputs[1] = neuron;
     }
     int ib(nb*p_IB);
     for (int i(0); i < ib; i++) {
-        neuron = new ExcitatoryNeuron(delta, type[2]);
+        neuron = new ExcitatoryNeuron(delta, *_random, type[2], &_neurons);
         _network.push_back(neuron);
         _neuronsforoutputs[2] = neuron;
     }
     int rz(nb*p_RZ);
     for (int i(0); i < rz; i++) {
-        neuron = new ExcitatoryNeuron(delta, type[3]);
+        neuron = new ExcitatoryNeuron(delta, *_random, type[3], &_neurons);
         _network.push_back(neuron);
         _neuronsforoutputs[3] = neuron;
     }
     int tc(nb*p_TC);
     for(int i(0); i < tc; i++) {
-        neuron = new ExcitatoryNeuron(delta, type[4]);
+        neuron = new ExcitatoryNeuron(delta, *_random, type[4], &_neurons);
         _network.push_back(neuron);
         _neuronsforoutputs[4] = neuron;
     }
     int ch(nb*p_CH);
     for(int i(0); i < ch; i++) {
-        neuron = new ExcitatoryNeuron(delta, type[5]);
+        neuron = new ExcitatoryNeuron(delta, *_random, type[5], &_neurons);
         _network.push_back(neuron);
         _neuronsforoutputs[5] = neuron;
     }
 
     for (int i(0); i < (nb - fs - lts - ib - rz - tc - ch); i++) {
-        neuron = new ExcitatoryNeuron(delta, type[6]);
+        neuron = new ExcitatoryNeuron(delta, *_random, type[6], &_neurons);
         _network.push_back(neuron);
         _neuronsforoutputs[6] = neuron;
     }
 
-    makeConnections(lambda);
+    connect(lambda, construction, threads);
+    makeBlocks();
+    resetSpikes();
+}
+
+Network::Network(const std::string& snapshot, Random& random)
+    : _random(&random), _scale(1), _propagation(_PROP_), _synchronous(false), _noiseSeed(0), _step(0), _maxDelay(0), _delaySeed(0), _precision('d'), _weightError(0), _neuronsforoutputs()
+{
+    std::shared_ptr<MappedFile> file(new MappedFile(snapshot));
+    const char* data(file->data());
+    uint32_t version(0), mark(0);
+    uint64_t nb(0), nonZeros(0);
+    if (file->size() < SNAPSHOT_ALIGN or std::memcmp(data, SNAPSHOT_MAGIC, sizeof(SNAPSHOT_MAGIC)) != 0) {
+        throw std::runtime_error("The file " + snapshot + " is not a network snapshot");
+    }
+    std::memcpy(&version, data + 8, 4);
+    std::memcpy(&mark, data + 12, 4);
+    //the snapshots of the first version are the ones of networks never reordered
+    if (version < 1 or version > SNAPSHOT_VERSION or mark != BYTE_ORDER_MARK) {
+        throw std::runtime_error("This version or byte order of network snapshot is not supported");
+    }
+    std::memcpy(&nb, data + 16, 8);
+    std::memcpy(&nonZeros, data + 24, 8);
+    //each neuron and each connection takes some bytes of the file, which bounds their numbers before any position is computed from them
+    if (nb > file->size() / (NeuronPool::COLUMNS * sizeof(double) + 1) or nb > uint64_t(INT32_MAX)
+        or nonZeros > file->size() / (sizeof(int32_t) + sizeof(double))) {
+        throw std::runtime_error("The network snapshot " + snapshot + " is truncated");
+    }
+    std::memcpy(&_intensity, data + 32, 8);
+    _model = data[40];
+    //positions of the arrays, in the order they are written
+    const size_t types(SNAPSHOT_ALIGN);
+    const size_t columns(types + aligned(nb));
+    const size_t offsets(columns + NeuronPool::COLUMNS * aligned(nb * sizeof(double)));
+    const size_t sources(offsets + aligned((nb + 1) * sizeof(uint64_t)));
+    const size_t weights(sources + aligned(nonZeros * sizeof(int32_t)));
+    const size_t order(weights + aligned(nonZeros * sizeof(double)));
+    const bool reordered(version > 1 and data[41] != 0);
+    if (file->size() < (reordered ? order + nb * sizeof(int32_t) : weights + nonZeros * sizeof(double))) {
+        throw std::runtime_error("The network snapshot " + snapshot + " is truncated");
+    }
+    std::array<const double*, NeuronPool::COLUMNS> pool;
+    for (size_t k(0); k < pool.size(); k++) {
+        pool[k] = reinterpret_cast<const double*>(data + columns + k * aligned(nb * sizeof(double)));
+    }
+    const uint64_t* rows(reinterpret_cast<const uint64_t*>(data + offsets));
+    const unsigned char* typeArray(reinterpret_cast<const unsigned char*>(data + types));
+    const int* sourceArray(reinterpret_cast<const int*>(data + sources));
+    //the arrays are checked before being read, so that a corrupted file cannot lead to reads out of them
+    bool valid(rows[0] == 0 and rows[nb] == nonZeros);
+    for (size_t i(0); valid and i < nb; i++) {
+        valid = rows[i] <= rows[i + 1] and typeArray[i] < NEURON_TYPES;
+    }
+    for (size_t k(0); valid and k < nonZeros; k++) {
+        valid = sourceArray[k] >= 0 and uint64_t(sourceArray[k]) < nb;
+    }
+    if (valid and reordered) {
+        const int* orderArray(reinterpret_cast<const int*>(data + order));
+        std::vector<bool> seen(nb, false);
+        for (size_t i(0); valid and i < nb; i++) {
+            valid = orderArray[i] >= 0 and uint64_t(orderArray[i]) < nb and not seen[orderArray[i]];
+            if (valid) {
+                seen[orderArray[i]] = true;
+            }
+        }
+    }
+    if (not valid) {
+        throw std::runtime_error("The network snapshot " + snapshot + " is corrupted");
+    }
+    _neurons.assign(nb, typeArray, pool);
+    for (size_t i(0); i < nb; i++) {
+        Neuron* neuron(new Neuron(_neurons, i));
+        _network.push_back(neuron);
+        _neuronsforoutputs[_neurons.types()[i]] = neuron;
+    }
+    const double* weightArray(reinterpret_cast<const double*>(data + weights));
+    if (sizeof(size_t) == sizeof(uint64_t)) {
+        //the connections stay in the mapped file, which is kept as long as the matrix
+        _connections = SynapseMatrix(nb, reinterpret_cast<const size_t*>(rows), sourceArray, weightArray, file);
+    }
+    else {
+        _connections = SynapseMatrix(std::vector<size_t>(rows, rows + nb + 1), std::vector<int>(sourceArray, sourceArray + nonZeros),
+                                     std::vector<double>(weightArray, weightArray + nonZeros));
+    }
+    if (reordered) {
+        const int* orderArray(reinterpret_cast<const int*>(data + order));
+        _order.assign(orderArray, orderArray + nb);
+    }
+    makeBlocks();
+    resetSpikes();
+}
+
+Network::Network(const Network& topology, double intensity, double delta, Random& random)
+    : _random(&random), _order(topology._order), _connections(topology._connections.withPrecision('d')), _intensity(intensity), _scale(topology._scale * intensity / topology._intensity),
+      _model(topology._model), _propagation(_PROP_), _synchronous(false), _noiseSeed(0), _step(0), _maxDelay(0), _delaySeed(0), _precision('d'), _weightError(0), _neuronsforoutputs()
+{
+    const size_t nb(topology._neurons.size());
+    _neurons.reserve(nb);
+    for (size_t i(0); i < nb; i++) {
+        const std::string type(topology._neurons.getType(i));
+        Neuron* neuron;
+        if (type == "FS" or type == "LTS") {
+            neuron = new InhibitoryNeuron(delta, *_random, type, &_neurons);
+        }
+        else {
+            neuron = new ExcitatoryNeuron(delta, *_random, type, &_neurons);
+        }
+        _network.push_back(neuron);
+        _neuronsforoutputs[topology._neurons.types()[i]] = neuron;
+    }
+    makeBlocks();
+    resetSpikes();
+}
+
+Network::Network(const Network& neurons, const SynapseMatrix& connections, Random& random)
+    : _random(&random), _order(neurons._order), _connections(connections.withPrecision('d')), _intensity(neurons._intensity), _scale(neurons._scale),
+      _model(neurons._model), _propagation(_PROP_), _synchronous(false), _noiseSeed(0), _step(0), _maxDelay(0), _delaySeed(0), _precision('d'), _weightError(0), _neuronsforoutputs()
+{
+    const size_t nb(neurons._neurons.size());
+    bool valid(connections.size() == nb);
+    for (size_t k(0); valid and k < connections.nonZeros(); k++) {
+        valid = connections.sources()[k] >= 0 and size_t(connections.sources()[k]) < nb;
+    }
+    if (not valid) {
+        throw std::domain_error("The connections must have one row for each neuron of the network, and sources among its neurons");
+    }
+    std::vector<std::vector<double>> columns(NeuronPool::COLUMNS);
+    std::array<const double*, NeuronPool::COLUMNS> pool;
+    for (size_t k(0); k < NeuronPool::COLUMNS; k++) {
+        columns[k] = neurons._neurons.column(k);
+        pool[k] = columns[k].data();
+    }
+    _neurons.assign(nb, neurons._neurons.types(), pool);
+    for (size_t i(0); i < nb; i++) {
+        Neuron* neuron(new Neuron(_neurons, i));
+        _network.push_back(neuron);
+    }
+    for (size_t k(0); k < _neuronsforoutputs.size(); k++) {
+        const Neuron* output(neurons._neuronsforoutputs[k]);
+        _neuronsforoutputs[k] = output == nullptr ? nullptr : _network[output->getIndex()];
+    }
+    makeBlocks();
+    resetSpikes();
+}
+
+void Network::reorder() {
+    const size_t nb(_neurons.size());
+    //each neuron stays in its run, the reverse Cuthill-McKee order being kept within each run
+    std::vector<int> run(nb);
+    for (size_t b(0); b < _blocks.size(); b++) {
+        std::fill(run.begin() + _blocks[b].begin, run.begin() + _blocks[b].end, b);
+    }
+    std::vector<int> order(_connections.reverseCuthillMcKee());
+    std::stable_sort(order.begin(), order.end(), [&run](int i, int j) {return run[i] < run[j];});
+    std::vector<unsigned char> types(nb);
+    std::vector<std::vector<double>> columns(NeuronPool::COLUMNS, std::vector<double>(nb));
+    std::array<const double*, NeuronPool::COLUMNS> pool;
+    for (size_t k(0); k < NeuronPool::COLUMNS; k++) {
+        const std::vector<double> column(_neurons.column(k));
+        for (size_t n(0); n < nb; n++) {
+            columns[k][n] = column[order[n]];
+        }
+        pool[k] = columns[k].data();
+    }
+    for (size_t n(0); n < nb; n++) {
+        types[n] = _neurons.types()[order[n]];
+    }
+    _neurons.assign(nb, types.data(), pool);
+    _connections = _connections.permute(order);
+    //the order is composed with the one of a network already reordered
+    std::vector<int> original(nb);
+    for (size_t n(0); n < nb; n++) {
+        original[n] = _order.empty() ? order[n] : _order[order[n]];
+    }
+    _order.swap(original);
+    //the neurons of the outputs are the last ones of each type in the original order, as when the network is built
+    std::vector<int> position(nb);
+    for (size_t n(0); n < nb; n++) {
+        position[_order[n]] = n;
+    }
+    for (size_t i(0); i < nb; i++) {
+        _neuronsforoutputs[_neurons.types()[position[i]]] = _network[position[i]];
+    }
+    makeBlocks();
+    if (_propagation == 'e') {
+        _outgoing = _connections.transpose();
+    }
+    if (_maxDelay > 0) {
+        setDelays(_maxDelay, _delaySeed);
+    }
+    else {
+        prepare();
+    }
+}
+
+const std::vector<int>& Network::getOrder() const {
+    return _order;
+}
+
+void Network::getOriginalSpikes(std::vector<uint64_t>& spikes) const {
+    if (_order.empty()) {
+        spikes = _spikes;
+        return;
+    }
+    spikes.assign(_spikes.size(), 0);
+    for (size_t word(0); word < _spikes.size(); ++word) {
+        for (uint64_t bits(_spikes[word]); bits != 0; bits &= bits - 1) {
+            const int i(_order[64*word + __builtin_ctzll(bits)]);
+            spikes[i >> 6] |= uint64_t(1) << (i & 63);
+        }
+    }
+}
+
+void Network::save(const std::string& snapshot) const {
+    std::ofstream out(snapshot, std::ios::out | std::ios::binary);
+    if (not out.is_open()) {
+        throw std::runtime_error("The file " + snapshot + " cannot be written");
+    }
+    const uint64_t nb(_neurons.size());
+    const uint64_t nonZeros(_connections.nonZeros());
+    char header[SNAPSHOT_ALIGN] = {0};
+    std::memcpy(header, SNAPSHOT_MAGIC, sizeof(SNAPSHOT_MAGIC));
+    std::memcpy(header + 8, &SNAPSHOT_VERSION, 4);
+    std::memcpy(header + 12, &BYTE_ORDER_MARK, 4);
+    std::memcpy(header + 16, &nb, 8);
+    std::memcpy(header + 24, &nonZeros, 8);
+    std::memcpy(header + 32, &_intensity, 8);
+    header[40] = _model;
+    header[41] = not _order.empty();
+    out.write(header, sizeof(header));
+    writeArray(out, _neurons.types(), nb);
+    for (size_t k(0); k < NeuronPool::COLUMNS; k++) {
+        writeArray(out, _neurons.column(k).data(), nb * sizeof(double));
+    }
+    const std::vector<uint64_t> offsets(_connections.offsets(), _connections.offsets() + nb + 1);
+    writeArray(out, offsets.data(), offsets.size() * sizeof(uint64_t));
+    writeArray(out, _connections.sources(), nonZeros * sizeof(int32_t));
+    if (_scale == 1 and _connections.precision() == 'd') {
+        writeArray(out, _connections.weights(), nonZeros * sizeof(double));
+    }
+    else {
+        //the intensities shared with another network, or in a reduced precision, are written in double as they are used
+        const SynapseMatrix weights(_connections.withPrecision('d'));
+        std::vector<double> scaled(weights.weights(), weights.weights() + nonZeros);
+        for (auto& weight: scaled) {
+            weight *= _scale;
+        }
+        writeArray(out, scaled.data(), nonZeros * sizeof(double));
+    }
+    if (not _order.empty()) {
+        writeArray(out, _order.data(), nb * sizeof(int32_t));
+    }
+    if (not out) {
+        throw std::runtime_error("The network snapshot " + snapshot + " could not be written");
+    }
+}
+
+std::string Network::getState() const {
+    const uint64_t nb(_neurons.size());
+    std::string state;
+    state.reserve(sizeof(uint64_t)*(4 + _spikes.size()) + 3*nb*sizeof(double) + 2);
+    auto append = [&state](const void* data, size_t bytes) {state.append(static_cast<const char*>(data), bytes);};
+    append(&nb, sizeof(nb));
+    //v, u and current, the 5th to 7th arrays of the pool
+    for (size_t k(4); k < 7; k++) {
+        append(_neurons.column(k).data(), nb*sizeof(double));
+    }
+    append(_spikes.data(), _spikes.size()*sizeof(uint64_t));
+    append(&_noiseSeed, sizeof(_noiseSeed));
+    append(&_step, sizeof(_step));
+    state += _propagation;
+    state += char(_synchronous);
+    state += _precision;
+    const uint64_t delays(_maxDelay);
+    append(&delays, sizeof(delays));
+    append(&_delaySeed, sizeof(_delaySeed));
+    append(_delayed.data(), _delayed.size()*sizeof(double));
+    return state;
+}
+
+void Network::setState(const std::string& state) {
+    const uint64_t nb(_neurons.size());
+    const size_t words((nb + 63) / 64);
+    const size_t fixed(sizeof(uint64_t)*(5 + words) + 3*nb*sizeof(double) + 3);
+    uint64_t delays(0), delaySeed(0);
+    if (state.size() >= fixed) {
+        std::memcpy(&delays, state.data() + fixed - 2*sizeof(uint64_t), sizeof(delays));
+        std::memcpy(&delaySeed, state.data() + fixed - sizeof(uint64_t), sizeof(delaySeed));
+    }
+    if (state.size() < fixed or delays > UINT16_MAX or state.size() != fixed + delays*nb*sizeof(double)
+        or std::memcmp(state.data(), &nb, sizeof(nb)) != 0) {
+        throw std::runtime_error("The state does not match the neurons of the network");
+    }
+    const char* data(state.data() + sizeof(nb));
+    std::vector<double> variables(3*nb);
+    std::memcpy(variables.data(), data, 3*nb*sizeof(double));
+    data += 3*nb*sizeof(double);
+    for (size_t i(0); i < nb; i++) {
+        _neurons.setVariables(i, variables[i], variables[nb + i], variables[2*nb + i]);
+    }
+    std::vector<uint64_t> spikes(words);
+    std::memcpy(spikes.data(), data, words*sizeof(uint64_t));
+    data += words*sizeof(uint64_t);
+    std::memcpy(&_noiseSeed, data, sizeof(_noiseSeed));
+    uint64_t step;
+    std::memcpy(&step, data + sizeof(_noiseSeed), sizeof(step));
+    data += 2*sizeof(uint64_t);
+    _synchronous = false;
+    _maxDelay = 0;
+    _delays.clear();
+    //a reduced precision needs the synchronous update, restored below
+    if (data[2] == 'd') {
+        setPrecision('d');
+    }
+    setPropagation(data[0]);
+    setSynchronous(data[1]);
+    if (delays > 0) {
+        setDelays(delays, delaySeed);
+        std::memcpy(_delayed.data(), data + 3 + 2*sizeof(uint64_t), _delayed.size()*sizeof(double));
+    }
+    setPrecision(data[2]);
+    //prepare restarted the noise streams and rebuilt the spikes from the neurons
+    _step = step;
+    _spikes = spikes;
+    _fired.clear();
+    for (size_t i(0); i < nb; i++) {
+        if (getSpike(_spikes, i)) {
+            _fired.push_back(i);
+        }
+    }
 }
 
 Network::~Network()
@@ -79,28 +444,35 @@ Network::~Network()
         neuron = nullptr;
     }
 }
-void Network::makeConnections(double lambda) {
-    std::map<Neuron*, double> connections;
+void Network::makeConnections(double lambda, Random& random) {
+    const size_t nb(_neurons.size());
+    std::vector<size_t> offsets(1, 0);
+    std::vector<int> sources;
+    std::vector<double> weights;
+    offsets.reserve(nb + 1);
+    sources.reserve(nb * std::max(lambda, 0.0));
+    weights.reserve(nb * std::max(lambda, 0.0));
+    //row in which each neuron was last connected, to avoid connecting it twice to the same neuron
+    std::vector<size_t> connectedIn(nb, nb);
     bool avoidProblem(false);
-    for (size_t i(0); i<_network.size(); i++) {
-        connections.clear(); //avoid to recreate a new temporary map for each neuron
+    for (size_t i(0); i < nb; i++) {
         int nbConnections;
         if (_model == 'c') {
             nbConnections = int(lambda);
         }
         else if(_model == 'o') {
-            nbConnections = _RNG->poisson(_RNG->exponential(1/lambda));
+            nbConnections = random.poisson(random.exponential(1/lambda));
         }
         else {
-            nbConnections = _RNG->poisson(lambda);
+            nbConnections = random.poisson(lambda);
         }
-        for (int j(0); j < std::min(nbConnections, int(_network.size())-1) and _connections.size() < _network.size(); j++) {
+        for (int j(0); j < std::min(nbConnections, int(nb)-1); j++) {
         //we have to take the minimum of both, because the distribution result can be higher than lambda and make an error occuri
-            size_t k(_RNG->uniform_int(0, (_network.size() - 1)));//pick a random neuron and connect it to the actual neurons
+            size_t k(random.uniform_int(0, (nb - 1)));//pick a random neuron and connect it to the actual neurons
             //avoid to check the same neurons several times
-            while (connections.find(_network[k]) != connections.end() or k == i) {
+            while (connectedIn[k] == i or k == i) {
                 k+=1; //avoid an infinite loop
-                if (k > (_network.size() - 1)){
+                if (k > (nb - 1)){
                     if (avoidProblem) {
                         throw std::domain_error ("this neuron is already connected to all neurons of the network");
                     }
@@ -109,34 +481,501 @@ void Network::makeConnections(double lambda) {
                 }
             }
             avoidProblem = false;
-            connections.insert(std::make_pair(_network[k], _network[k]->factor()*_RNG->uniform_double(0, 2*_intensity)));
+            connectedIn[k] = i;
+            sources.push_back(k);
+            weights.push_back(_neurons.factor(k)*random.uniform_double(0, 2*_intensity));
         }
-        _connections.push_back(connections);
+        offsets.push_back(sources.size());
+    }
+    _connections = SynapseMatrix(std::move(offsets), std::move(sources), std::move(weights));
+}
+
+void Network::connect(double lambda, char construction, size_t threads) {
+    Random topology(_random->substream(Random::TOPOLOGY));
+    if (construction == 'p') {
+        makeConnections(lambda, topology.uniform_uint64(), threads);
+    }
+    else if (construction == 's') {
+        makeConnections(lambda, topology);
     }
+    else {
+        throw std::domain_error(std::string("The construction ") + construction + " does not exist");
+    }
+}
+
+void Network::makeConnections(double lambda, uint64_t seed, size_t threads) {
+    const size_t nb(_neurons.size());
+    _connections = drawConnections(_model, nb, 0, nb, lambda, _intensity, seed, threads, [this](size_t i) {return _neurons.factor(i);});
+}
+
+SynapseMatrix Network::drawConnections(char model, size_t nb, size_t begin, size_t end, double lambda, double intensity, uint64_t seed, size_t threads,
+                                       const std::function<double(size_t)>& factor) {
+    if (threads == 0) {
+        throw std::domain_error("At least one thread is needed to build the network");
+    }
+    const size_t rows(end - begin);
+    ThreadPool pool(threads);
+    //contiguous ranges of neurons, one for each thread
+    auto first = [begin, rows, threads](size_t range) {return begin + rows * range / threads;};
+    //first pass: number of connections of each neuron, drawn from its first stream
+    std::vector<size_t> offsets(rows + 1, 0);
+    pool.run(threads, [&](size_t range) {
+        for (size_t i(first(range)); i < first(range + 1); i++) {
+            CounterStream stream(seed, 2*i);
+            int nbConnections(0);
+            if (model == 'c') {
+                nbConnections = int(lambda);
+            }
+            else if (lambda > 0) {
+                double mean(lambda);
+                if (model == 'o') {
+                    mean = std::exponential_distribution<>(1/lambda)(stream);
+                }
+                if (mean > 0) {
+                    nbConnections = std::poisson_distribution<>(mean)(stream);
+                }
+            }
+            offsets[i - begin + 1] = nb < 2 ? 0 : std::min(size_t(std::max(nbConnections, 0)), nb - 1);
+        }
+    });
+    std::partial_sum(offsets.begin(), offsets.end(), offsets.begin());
+    //second pass: sources and intensities, written in place in the rows, from the second stream of each neuron
+    std::vector<int> sources(offsets.back());
+    std::vector<double> weights(offsets.back());
+    pool.run(threads, [&](size_t range) {
+        //row in which each neuron was last chosen, to test in constant time if it already is a source of the row
+        std::vector<int> chosenIn(nb, -1);
+        std::uniform_real_distribution<> draw(0, 2*intensity);
+        for (size_t i(first(range)); i < first(range + 1); i++) {
+            CounterStream stream(seed, 2*i + 1);
+            const size_t row(i - begin);
+            int* chosen(sources.data() + offsets[row]);
+            const size_t count(offsets[row + 1] - offsets[row]);
+            //Floyd's algorithm, drawing among the nb-1 other neurons: candidate t is the neuron t, or t+1 after the neuron i
+            auto neuron = [i](size_t t) {return t < i ? t : t + 1;};
+            for (size_t j(nb - 1 - count); j < nb - 1; j++) {
+                size_t k(neuron(std::uniform_int_distribution<size_t>(0, j)(stream)));
+                if (chosenIn[k] == int(i)) {
+                    k = neuron(j);
+                }
+                chosenIn[k] = i;
+                *chosen++ = k;
+            }
+            chosen -= count;
+            std::sort(chosen, chosen + count);
+            for (size_t k(offsets[row]); k < offsets[row + 1]; k++) {
+                weights[k] = factor(sources[k])*draw(stream);
+            }
+        }
+    });
+    return SynapseMatrix(std::move(offsets), std::move(sources), std::move(weights));
 }
 
 void Network::update() {
-    for (size_t i(0); i <_network.size(); i++) {
-        synapticCurrent(i);
-        _network[i]->update();
+    if (_synchronous) {
+        updateSynchronous();
+        return;
+    }
+    //nothing else draws from the generator during the step, so the noise of all neurons can be drawn first, in the same order
+    {
+        PROFILE_SCOPE(CURRENT);
+        _noise.resize(_neurons.size());
+        if (_order.empty()) {
+            _random->normal(_noise);
+        }
+        else {
+            //the numbers are drawn in the original order, each neuron getting the one of its original index
+            _drawn.resize(_noise.size());
+            _random->normal(_drawn);
+            for (size_t n(0); n < _noise.size(); n++) {
+                _noise[n] = _drawn[_order[n]];
+            }
+        }
+    }
+    //the synaptic inputs and the integration of each neuron alternate, and are timed together
+    PROFILE_SCOPE(UPDATE);
+    for (const TypeBlock& block: _blocks) {
+        updateBlock(block);
+    }
+}
+
+void Network::updateBlock(const TypeBlock& block) {
+    typedef void (Network::*BlockUpdate)(int, int);
+    static const BlockUpdate updates[NEURON_TYPES] = {
+        &Network::updateBlock<NeuronType::FS>, &Network::updateBlock<NeuronType::LTS>, &Network::updateBlock<NeuronType::IB>,
+        &Network::updateBlock<NeuronType::RZ>, &Network::updateBlock<NeuronType::TC>, &Network::updateBlock<NeuronType::CH>,
+        &Network::updateBlock<NeuronType::RS>
+    };
+    if (block.traits) {
+        (this->*updates[size_t(block.type)])(block.begin, block.end);
+        return;
+    }
+    for (int i(block.begin); i < block.end; i++) {
+        _neurons.setCurrent(i, _neurons.getW(i)*_noise[i] + _scale*synapticInput(i));
+        _neurons.update(i);
+        setSpike(_spikes, i, _neurons.isFiring(i));
+    }
+}
+
+template<NeuronType T>
+void Network::updateBlock(int begin, int end) {
+    //the amplitude of the noise is a constant of the type
+    constexpr double w(typeTraits(T).w);
+    for (int i(begin); i < end; i++) {
+        _neurons.setCurrent(i, w*_noise[i] + _scale*synapticInput(i));
+        _neurons.update(i);
+        setSpike(_spikes, i, _neurons.isFiring(i));
+    }
+}
+
+void Network::setCurrents(const TypeBlock& block, int begin, int end) {
+    typedef void (Network::*BlockCurrents)(int, int);
+    static const BlockCurrents currents[NEURON_TYPES] = {
+        &Network::setCurrents<NeuronType::FS>, &Network::setCurrents<NeuronType::LTS>, &Network::setCurrents<NeuronType::IB>,
+        &Network::setCurrents<NeuronType::RZ>, &Network::setCurrents<NeuronType::TC>, &Network::setCurrents<NeuronType::CH>,
+        &Network::setCurrents<NeuronType::RS>
+    };
+    if (block.traits) {
+        (this->*currents[size_t(block.type)])(begin, end);
+        return;
+    }
+    for (int i(begin); i < end; i++) {
+        _neurons.setCurrent(i, _neurons.getW(i)*_noise[i] + _scale*_input[i]);
+    }
+}
+
+template<NeuronType T>
+void Network::setCurrents(int begin, int end) {
+    constexpr double w(typeTraits(T).w);
+    for (int i(begin); i < end; i++) {
+        _neurons.setCurrent(i, w*_noise[i] + _scale*_input[i]);
+    }
+}
+
+void Network::makeBlocks() {
+    _blocks.clear();
+    for (size_t i(0); i < _neurons.size(); i++) {
+        const NeuronType type(_neurons.typeOf(i));
+        const bool traits(_neurons.getW(i) == typeTraits(type).w);
+        if (_blocks.empty() or _blocks.back().type != type or _blocks.back().traits != traits) {
+            _blocks.push_back({type, int(i), int(i), traits});
+        }
+        _blocks.back().end = i + 1;
+    }
+}
+
+void Network::updateSynchronous() {
+    if (not _order.empty()) {
+        //the noise of a reordered network is drawn in the original order of the neurons, from the stream of each original index
+        _drawn.resize(_neurons.size());
+        _threads->run(_ranges.size() - 1, [this](size_t range) {
+            PROFILE_SCOPE(CURRENT);
+            Random::counter_normals(_noiseSeed, _ranges[range], _step, _ranges[range + 1] - _ranges[range], &_drawn[_ranges[range]]);
+        });
+    }
+    _threads->run(_ranges.size() - 1, [this](size_t range) {updateRange(range);});
+    std::swap(_spikes, _nextSpikes);
+    if (_propagation == 'e') {
+        _fired.clear();
+        for (auto& fired: _rangeFired) {
+            _fired.insert(_fired.end(), fired.begin(), fired.end());
+        }
     }
+    _step += 1;
+}
+
+void Network::updateRange(size_t range) {
+    const int begin(_ranges[range]);
+    const int end(_ranges[range + 1]);
+    {
+        PROFILE_SCOPE(CURRENT);
+        const SynapseMatrix& walked(_propagation == 'e' ? _outgoing : _connections);
+        if (walked.precision() == 'f') {
+            sumInputs(begin, end, walked.weights32(), 1.0);
+        }
+        else if (walked.precision() == 'h') {
+            sumInputs(begin, end, walked.weights16(), walked.unit());
+        }
+        else {
+            sumInputs(begin, end, walked.weights(), 1.0);
+        }
+        if (_order.empty()) {
+            Random::counter_normals(_noiseSeed, begin, _step, end - begin, &_noise[begin]);
+        }
+        else {
+            //each neuron reads the noise of its original index, so that the reordering does not change the simulation
+            for (int i(begin); i < end; i++) {
+                _noise[i] = _drawn[_order[i]];
+            }
+        }
+        for (const TypeBlock& block: _blocks) {
+            if (block.begin < end and block.end > begin) {
+                setCurrents(block, std::max(begin, block.begin), std::min(end, block.end));
+            }
+        }
+    }
+    PROFILE_SCOPE(UPDATE);
+    uint64_t* spikes(&_nextSpikes[begin >> 6]);
+    _neurons.update(begin, end, spikes);
+    if (_propagation == 'e') {
+        std::vector<int>& fired(_rangeFired[range]);
+        fired.clear();
+        for (int word(0); word < (end - begin + 63) / 64; word++) {
+            for (uint64_t bits(spikes[word]); bits != 0; bits &= bits - 1) {
+                fired.push_back(begin + 64*word + __builtin_ctzll(bits));
+            }
+        }
+    }
+}
+
+template<class W>
+void Network::sumInputs(int begin, int end, const W* weights, double unit) {
+    if (_maxDelay > 0) {
+        deliverDelayed(begin, end, weights, unit);
+    }
+    else if (_propagation == 'e') {
+        const bool whole(begin == 0 and end == int(_neurons.size()));
+        std::fill(_input.begin() + begin, _input.begin() + end, 0.0);
+        //the fired neurons are read in the same order by all ranges, so each input is summed in the same order whatever the number of threads
+        for (auto source: _fired) {
+            const int* first(_outgoing.sources(source));
+            const int* last(first + _outgoing.degree(source));
+            const W* row(weights + _outgoing.offsets()[source]);
+            for (const int* target(whole ? first : std::lower_bound(first, last, begin)); target != last and *target < end; ++target) {
+                _input[*target] += unit*row[target - first];
+            }
+        }
+    }
+    else {
+        //same order of summation as the events: by increasing index of the fired neuron
+        for (int i(begin); i < end; i++) {
+            double input(0);
+            const int* sources(_connections.sources(i));
+            const W* row(weights + _connections.offsets()[i]);
+            for (size_t k(0); k < _connections.degree(i); k++) {
+                if (getSpike(_spikes, sources[k])) {
+                    input += unit*row[k];
+                }
+            }
+            _input[i] = input;
+        }
+    }
+}
+
+template<class W>
+void Network::deliverDelayed(int begin, int end, const W* weights, double unit) {
+    const size_t nb(_neurons.size());
+    const bool whole(begin == 0 and end == int(nb));
+    //a spike of the last update (step _step - 1) with a delay d arrives at the step _step - 1 + d
+    for (auto source: _fired) {
+        const int* first(_outgoing.sources(source));
+        const int* last(first + _outgoing.degree(source));
+        const W* row(weights + _outgoing.offsets()[source]);
+        const uint16_t* delays(_delays.data() + _outgoing.offsets()[source]);
+        for (const int* target(whole ? first : std::lower_bound(first, last, begin)); target != last and *target < end; ++target) {
+            const size_t slot((_step + delays[target - first] - 1) % _maxDelay);
+            _delayed[slot*nb + *target] += unit*row[target - first];
+        }
+    }
+    //the slot of this step is complete, and is then reused for the step _step + _maxDelay
+    double* arriving(_delayed.data() + (_step % _maxDelay)*nb);
+    std::copy(arriving + begin, arriving + end, _input.begin() + begin);
+    std::fill(arriving + begin, arriving + end, 0.0);
+}
+
+void Network::setPrecision(char precision) {
+    if (precision != 'd' and precision != 'f' and precision != 'h') {
+        throw std::domain_error(std::string("The precision ") + precision + " does not exist");
+    }
+    if (precision != 'd' and not _synchronous) {
+        throw std::domain_error("The reduced precisions are only read by the synchronous update");
+    }
+    if (precision == _precision) {
+        return;
+    }
+    //the intensities are only kept in the new precision, the error being measured against the ones they are rounded from
+    const SynapseMatrix connections(_connections.withPrecision(precision));
+    _weightError = 0;
+    for (size_t i(0); i < connections.size(); i++) {
+        for (size_t k(0); k < connections.degree(i); k++) {
+            _weightError = std::max(_weightError, std::abs(connections.weight(i, k) - _connections.weight(i, k)));
+        }
+    }
+    _connections = connections;
+    _outgoing = _outgoing.withPrecision(precision);
+    _precision = precision;
+    _neurons.setSinglePrecision(precision != 'd');
+}
+
+char Network::getPrecision() const {
+    return _precision;
+}
+
+double Network::getWeightError() const {
+    return _weightError;
+}
+
+void Network::setDelays(int maxDelay, uint64_t seed) {
+    if (maxDelay < 1 or maxDelay > UINT16_MAX) {
+        throw std::domain_error("The largest delay must be between 1 and " + std::to_string(UINT16_MAX) + " steps");
+    }
+    setPropagation('e');
+    _maxDelay = maxDelay;
+    _delaySeed = seed;
+    _delays.resize(_outgoing.nonZeros());
+    //the delays do not depend on the order of the neurons
+    auto original = [this](size_t i) -> uint64_t {return _order.empty() ? i : _order[i];};
+    for (size_t source(0); source < _outgoing.size(); source++) {
+        for (size_t k(_outgoing.offsets()[source]); k < _outgoing.offsets()[source + 1]; k++) {
+            _delays[k] = 1 + Random::counter_hash(seed, original(_outgoing.sources()[k]), original(source)) % maxDelay;
+        }
+    }
+    prepare();
+}
+
+int Network::getMaxDelay() const {
+    return _maxDelay;
+}
+
+const std::vector<uint16_t>& Network::getDelays() const {
+    return _delays;
+}
+
+void Network::setPropagation(char propagation) {
+    if (propagation != 's' and propagation != 'e') {
+        throw std::domain_error(std::string("The propagation ") + propagation + " does not exist");
+    }
+    if (propagation != 'e' and _maxDelay > 0) {
+        throw std::domain_error("The delays are delivered by the event-driven propagation");
+    }
+    _propagation = propagation;
+    if (propagation == 'e') {
+        if (_outgoing.size() != _connections.size()) {
+            _outgoing = _connections.transpose();
+        }
+        _synchronous = true;
+    }
+    prepare();
+}
+
+void Network::setSynchronous(bool synchronous) {
+    if (not synchronous and _propagation == 'e') {
+        throw std::domain_error("The event-driven propagation is always synchronous");
+    }
+    if (not synchronous and _precision != 'd') {
+        throw std::domain_error("The reduced precisions are only read by the synchronous update");
+    }
+    _synchronous = synchronous;
+    prepare();
+}
+
+void Network::prepare() {
+    resetSpikes();
+    if (not _synchronous) {
+        return;
+    }
+    _input.assign(_neurons.size(), 0.0);
+    _noise.assign(_neurons.size(), 0.0);
+    _delayed.assign(size_t(_maxDelay)*_neurons.size(), 0.0);
+    _nextSpikes.assign(_spikes.size(), 0);
+    _fired.clear();
+    for (size_t i(0); i < _neurons.size(); i++) {
+        if (_neurons.isFiring(i)) {
+            _fired.push_back(i);
+        }
+    }
+    if (_noiseSeed == 0) {
+        _noiseSeed = _random->uniform_uint64();
+    }
+    _step = 0;
+    if (not _threads) {
+        setThreads(1);
+    }
+}
+
+void Network::resetSpikes() {
+    _spikes.assign((_neurons.size() + 63) / 64, 0);
+    for (size_t i(0); i < _neurons.size(); i++) {
+        setSpike(_spikes, i, _neurons.isFiring(i));
+    }
+}
+
+void Network::setThreads(size_t threads) {
+    if (threads == 0) {
+        throw std::domain_error("At least one thread is needed to update the network");
+    }
+    _threads.reset(new ThreadPool(threads));
+    //ranges of neurons aligned on _ALIGN_ neurons, one for each thread
+    const size_t nb(_neurons.size());
+    const size_t chunks((nb + _ALIGN_ - 1) / _ALIGN_);
+    _ranges.clear();
+    for (size_t t(0); t <= threads; t++) {
+        _ranges.push_back(std::min(nb, (chunks * t / threads) * _ALIGN_));
+    }
+    _ranges.erase(std::unique(_ranges.begin(), _ranges.end()), _ranges.end());
+    if (_ranges.size() < 2) {
+        _ranges.push_back(nb);
+    }
+    _rangeFired.resize(_ranges.size() - 1);
+}
+
+size_t Network::getThreads() const {
+    return _threads ? _threads->size() : 1;
+}
+
+uint64_t Network::getNoiseSeed() const {
+    return _noiseSeed;
+}
+
+uint64_t Network::getStep() const {
+    return _step;
+}
+
+double Network::getScale() const {
+    return _scale;
+}
+
+char Network::getPropagation() const {
+    return _propagation;
+}
+
+bool Network::isSynchronous() const {
+    return _synchronous;
+}
+
+const std::vector<uint64_t>& Network::getSpikes() const {
+    return _spikes;
+}
+
+const std::vector<TypeBlock>& Network::getBlocks() const {
+    return _blocks;
+}
+
+const std::vector<int>& Network::getFired() const {
+    return _fired;
 }
 
 void Network::synapticCurrent(int index) {
+    _neurons.setCurrent(index, _neurons.noise(index, *_random) + _scale*synapticInput(index));
+}
+
+double Network::synapticInput(int index) const {
     double input(0);
-    for (auto& pair: _connections[index]) {
-        if (pair.first->isFiring()) {
-            input += pair.second;
+    const int* sources(_connections.sources(index));
+    const double* weights(_connections.weights(index));
+    for (size_t k(0); k < _connections.degree(index); k++) {
+        if (_neurons.isFiring(sources[k])) {
+            input += weights[k];
         }
     }
-    _network[index]->setCurrent(_network[index]->noise() + input);
-
+    return input;
 }
 
 std::vector<bool> Network::getCurrentstatus() const {
     std::vector<bool> status;
-    for (size_t i(0); i < _network.size(); i++) {
-        status.push_back(_network[i]->isFiring());
+    status.reserve(_neurons.size());
+    for (size_t i(0); i < _neurons.size(); i++) {
+        status.push_back(getSpike(_spikes, i));
     }
     return status;
 }
@@ -144,7 +983,11 @@ std::vector<bool> Network::getCurrentstatus() const {
 std::vector<Neuron*> Network::getNet() const {
     return _network ;
 }
-std::vector<std::map<Neuron*, double>> Network::getCon() const {
+
+const NeuronPool& Network::getNeurons() const {
+    return _neurons;
+}
+const SynapseMatrix& Network::getCon() const {
     return _connections;
 }
 
@@ -153,9 +996,5 @@ std::array<Neuron*,7> Network::getNeuronsOutput() const {
 }
 
 double Network::getValence(int index) const {
-    double input(0);
-    for (auto& pair: _connections[index]) {
-            input += pair.second;
-    }
-    return input;
+    return _scale*_connections.valence(index);
 }
\ No newline at end of file
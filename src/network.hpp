@@ -1,10 +1,18 @@
 #ifndef NETWORK_HPP
 #define NETWORK_HPP
 #include <vector>
-#include <map>
 #include <array>
+#include <memory>
+#include <string>
+#include <cstdint>
+#include <functional>
 #include "random.hpp"
 #include "neuron.hpp"
+#include "neuronPool.hpp"
+#include "neuronTypes.hpp"
+#include "synapseMatrix.hpp"
+#include "threadPool.hpp"
+#include "constants.hpp"
 
 
 /**
@@ -27,8 +35,12 @@ public:
       @param intensity the mean intensity of connection
       @param lambda the mean connectivity between neurons
       @param delta the variability around 1 of distribution of noise
+      @param random the generator of the parameters, the connections and the noise, kept by the network
+      @param construction the construction of the connections, 's' for sequential or 'p' for parallel (see \ref makeConnections)
+      @param threads the number of threads building the connections in parallel
     */
-  Network(char model, int nb, double p_E, double intensity, double lambda, double delta);
+  Network(char model, int nb, double p_E, double intensity, double lambda, double delta, Random& random,
+          char construction = _CONSTRUCTION_, size_t threads = _THREADS_);
 
   /*! @brief Constructor with extended neurons types.
       Initializes the network by adding the neurons, given the different types proportions.
@@ -45,10 +57,44 @@ public:
       @param intensity the mean intensity of connection
       @param lambda the mean connectivity between neurons
       @param delta the variability around 1 for the distribution of the noise
+      @param random the generator of the parameters, the connections and the noise, kept by the network
+      @param construction the construction of the connections, 's' for sequential or 'p' for parallel (see \ref makeConnections)
+      @param threads the number of threads building the connections in parallel
     */
-  Network(char model, int nb, double p_FS, double p_IB, double p_RZ, double p_LTS, double p_TC, double p_CH, double intensity, double lambda, double delta);
+  Network(char model, int nb, double p_FS, double p_IB, double p_RZ, double p_LTS, double p_TC, double p_CH, double intensity, double lambda, double delta,
+          Random& random, char construction = _CONSTRUCTION_, size_t threads = _THREADS_);
 
-  /*! @brief Destroys all neurons in the set*/
+  /*! @brief Constructor from a snapshot written by \ref save.
+      The neurons are copied from the file, while the connections are read directly from the file mapped in memory,
+      without being copied nor sorted again, only read once to check that the sources are neurons of the network.
+      @param snapshot the name of the file
+      @param random the generator of the noise, kept by the network
+      @note Throws a runtime error if the file is not a valid snapshot, or if its offsets, sources, types or order are not consistent
+    */
+  Network(const std::string& snapshot, Random& random);
+
+  /*! @brief Constructor sharing the connections of another network, to simulate it again with other dynamic parameters.
+      The neurons have the same types as in the other network, their parameters being drawn again with delta.
+      The connections are not copied: their intensities are scaled from the mean intensity of the other network to the new one
+      when the synaptic currents are summed, which has the same distribution as drawing them again with the new intensity.
+      @param topology the network whose connections are shared, which can be destroyed afterwards
+      @param intensity the mean intensity of connection
+      @param delta the variability around 1 of distribution of noise
+      @param random the generator of the parameters and the noise, kept by the network
+    */
+  Network(const Network& topology, double intensity, double delta, Random& random);
+
+  /*! @brief Constructor with the neurons of another network and other connections, for instance made by another program.
+      The neurons are copied with their parameters, their state and their original order (see \ref reorder),
+      and the connections are copied in double precision, with the same scale as in the other network.
+      @param neurons the network whose neurons are copied, which can be destroyed afterwards
+      @param connections the matrix whose row i holds the connections received by the neuron i, sorted by source
+      @param random the generator of the noise, kept by the network
+      @note Throws a domain error if the matrix has not one row per neuron, or if a source is not a neuron of the network
+    */
+  Network(const Network& neurons, const SynapseMatrix& connections, Random& random);
+
+  /*! @brief Destroys all neuron views in the set*/
   ~Network();
 
   /*! @brief Initializes the connections.
@@ -56,14 +102,186 @@ public:
   * If the model is <b>basic</b> ("b"), the number of connection for each neuron is around the mean and only few of them are making extreme numbers of connections.
   * If the model is <b>constant</b> ("c"), the number of connection for each neuron is the same and equals lambda.
   * If the model is <b>overdisplayed</b> ("o"), the number of connection for each neuron is overdisplayed, meaning that there is less and less neurons making a bigger number of connection.
-  * Connects randomly the neurons 
+  * Connects randomly the neurons, and stores the connections once for all in a \ref SynapseMatrix.
   * @param lambda , the mean parameter used to compute how many connection a number will make.
+  * @param random the generator from which the connections are drawn
+  */
+  void makeConnections(double lambda, Random& random);
+
+  /*! @brief Initializes the connections in parallel, with the same models as \ref makeConnections(double, Random&).
+  * Each neuron draws from its own counter-based streams (see \ref CounterStream): the number of its connections from the first one,
+  * then its distinct sources from the second one with Floyd's sampling without replacement, and their intensities.
+  * A first pass counts the connections of all neurons, a second one fills the arrays of the \ref SynapseMatrix in place.
+  * The connections only depend on the seed, and not on the number of threads.
+  * @param lambda the mean parameter used to compute how many connection a number will make.
+  * @param seed the seed of the streams of the neurons
+  * @param threads the number of threads, at least 1
   */
-  void makeConnections(double lambda);
+  void makeConnections(double lambda, uint64_t seed, size_t threads);
 
-  /*! @brief Updates the neurons*/
+  /*! @brief Draws the connections received by a range of neurons as \ref makeConnections(double, uint64_t, size_t) does.
+  * Each row only depends on the seed and on its neuron, so that the rows of a network can be drawn separately, for instance by several processes.
+  * @param model the model of connection
+  * @param nb the number of neurons of the network
+  * @param begin,end the range of neurons whose rows are drawn
+  * @param lambda the mean parameter used to compute how many connection a number will make
+  * @param intensity the mean intensity of connection
+  * @param seed the seed of the streams of the neurons
+  * @param threads the number of threads, at least 1
+  * @param factor the factor applied to the connections made by each neuron of the network
+  * @return the matrix whose row r holds the connections received by the neuron begin + r, with the indices of the neurons in the whole network
+  */
+  static SynapseMatrix drawConnections(char model, size_t nb, size_t begin, size_t end, double lambda, double intensity, uint64_t seed, size_t threads,
+                                       const std::function<double(size_t)>& factor);
+
+  /*! @brief Renumbers the neurons so that connected neurons get close indices, and the events of a spike add their inputs to fewer cache lines.
+   *  Only a network with local connections numbered in another order gains from it, for instance one loaded from a snapshot:
+   *  the connections drawn by the models have no locality to recover.
+   *  The order is the reverse Cuthill-McKee order of the connections (see \ref SynapseMatrix::reverseCuthillMcKee),
+   *  each neuron staying within its run of neurons of the same type, so that the runs and their specialised loops are unchanged (see \ref getBlocks).
+   *  The neurons, the connections, sorted again within each row, and the delays are renumbered, and the spikes can be read back in the original order
+   *  with \ref getOriginalSpikes.
+   *  The noise and the delays of each neuron are still drawn from its original index, so that a synchronous update gives the same spikes
+   *  up to the rounding of the inputs, summed in another order; an asynchronous update reads the neurons updated before, which depends on the order.
+   *  @note To be called before the simulation: the inputs on their way are lost
+   */
+  void reorder();
+
+  /*! @brief Getter for the original index of each neuron, in the order in which the network was built
+   *  @return the index each neuron had before \ref reorder, empty if the network was not reordered
+   */
+  const std::vector<int>& getOrder() const;
+
+  /*! @brief Writes the spikes of the last update in the original order of the neurons (see \ref reorder)
+   *  @param spikes the bitmask in which the spikes are written, as in \ref getSpikes
+   */
+  void getOriginalSpikes(std::vector<uint64_t>& spikes) const;
+
+  /*! @brief Writes a snapshot of the network, which can be loaded with \ref Network(const std::string&).
+   *  The file starts with a header of 64 bytes: the magic string "IZNETWRK", the version (uint32), the byte order mark 0x01020304 (uint32),
+   *  the number of neurons, of connections (uint64), the mean intensity (double), the model (char) and a reordered flag (char).
+   *  Follow the arrays of the neurons (the types, as uint8, then a, b, c, d, v, u, current, w and factor, as doubles)
+   *  and of the connections (offsets as uint64, sources as int32, intensities as doubles), each one starting on a multiple of 64 bytes,
+   *  and for a reordered network the original index of each neuron (int32, see \ref reorder).
+   *  The numbers are written in the byte order of the machine, so that the arrays can be used in place once mapped in memory.
+   *  @param snapshot the name of the file
+   */
+  void save(const std::string& snapshot) const;
+
+  /*! @brief Getter for the dynamic state of the network, to continue the simulation later from the same network.
+   *  @return the variables v, u and current of the neurons, the spikes of the last update, the noise streams,
+   *  the propagation, the synchronous mode, the delays and the inputs still on their way, as binary data
+   */
+  std::string getState() const;
+
+  /*! @brief Restores a state given by \ref getState, including the propagation, the synchronous mode and the delays
+   *  @note Throws a runtime error if the state does not match the neurons of the network
+   */
+  void setState(const std::string& state);
+
+  /*! @brief Updates the neurons, computing the synaptic currents as chosen with \ref setPropagation*/
   void update();
 
+  /*! @brief Chooses how the synaptic currents are computed at each update.
+   *  With <b>scan</b> ('s'), each neuron sums the intensities of all its incoming connections whose neuron is firing.
+   *  With <b>event</b> ('e'), the neurons which fired at the end of the previous step are listed,
+   *  and only their outgoing connections are walked to accumulate the currents, before all neurons are updated.
+   *  The cost of a step then depends on the number of spikes and not on the total number of connections.
+   *  @note The event-driven propagation is always synchronous (see \ref setSynchronous), and gives the same result as a synchronous scan.
+   *  @param propagation 's' for scan or 'e' for event
+   */
+  void setPropagation(char propagation);
+
+  /*! @brief Chooses between an asynchronous and a synchronous update.
+   *  In the <b>asynchronous</b> update, each neuron computes its current from the firing state of the others just before being updated:
+   *  the neurons of lower index have then already been updated during this step, so the result depends on the order of the neurons.
+   *  In the <b>synchronous</b> update, all neurons read the spikes of the previous step from one buffer, and write theirs in another one,
+   *  swapped at the end of the step. The noise of each neuron is then drawn from its own counter-based stream
+   *  (see \ref Random::counter_normal), so that the neurons can be updated in any order, and by several threads (see \ref setThreads).
+   *  @param synchronous true for a synchronous update
+   */
+  void setSynchronous(bool synchronous);
+
+  /*! @brief Tells if the update is synchronous*/
+  bool isSynchronous() const;
+
+  /*! @brief Gives each connection a transmission delay, drawn uniformly between 1 and maxDelay steps.
+   *  A spike emitted at a step reaches the neuron of a connection of delay d at the d-th next step, 1 being the delay of the synchronous update.
+   *  The spikes are delivered by the event-driven propagation (see \ref setPropagation) into a ring of maxDelay slots of N inputs,
+   *  slot s % maxDelay holding the inputs arriving at the step s: the cost of a step stays proportional to the spikes times their outgoing connections,
+   *  and the memory to maxDelay times N.
+   *  @param maxDelay the largest delay, in steps, between 1 and 65535
+   *  @param seed the seed of the delays, the delay of a connection being a hash of the seed and of the original indices of its two neurons
+   *  @note Chooses the event-driven propagation, which cannot be changed afterwards
+   */
+  void setDelays(int maxDelay, uint64_t seed);
+
+  /*! @brief Chooses the precision of the intensities and of the state of the neurons read by the synchronous update.
+   *  With <b>double</b> ('d'), everything is stored in double.
+   *  With <b>float</b> ('f') or <b>16-bit fixed point</b> ('h'), the intensities of the connections are only kept in 4 or 2 bytes
+   *  (see \ref SynapseMatrix::withPrecision), so that the matrices take and the synaptic loop reads 2 or 4 times less memory,
+   *  and the attributes and variables of the neurons are stored and integrated in float (see \ref NeuronPool::setSinglePrecision).
+   *  The currents are still summed in double. The rounding is not undone by going back to double, which keeps the rounded values.
+   *  @param precision 'd', 'f' or 'h'
+   *  @note Throws a domain error for a reduced precision in asynchronous mode
+   */
+  void setPrecision(char precision);
+
+  /*! @brief Getter for the precision of the intensities read by the synchronous update ('d', 'f' or 'h')*/
+  char getPrecision() const;
+
+  /*! @brief Largest difference between an intensity read by the synchronous update and the one it was rounded from, 0 in double precision*/
+  double getWeightError() const;
+
+  /*! @brief Getter for the largest delay of the connections, 0 without delays*/
+  int getMaxDelay() const;
+
+  /*! @brief Getter for the delays of the connections, in steps
+   *  @return one delay for each connection of the transposed matrix of the connections (see \ref SynapseMatrix::transpose), empty without delays
+   */
+  const std::vector<uint16_t>& getDelays() const;
+
+  /*! @brief Sets the number of threads updating the network in synchronous mode.
+   *  The neurons are split in as many contiguous ranges, each one receiving the spikes and being updated by one thread.
+   *  The result does not depend on the number of threads.
+   *  @note The asynchronous update is always done by a single thread, as each neuron depends on the ones updated before it.
+   *  @param threads the number of threads, at least 1
+   */
+  void setThreads(size_t threads);
+
+  /*! @brief Getter for the number of threads updating the network in synchronous mode*/
+  size_t getThreads() const;
+
+  /*! @brief Getter for the seed of the noise streams of the synchronous update, 0 until this mode is chosen*/
+  uint64_t getNoiseSeed() const;
+
+  /*! @brief Getter for the number of synchronous updates done, used as counter of the noise streams*/
+  uint64_t getStep() const;
+
+  /*! @brief Getter for the factor applied to the intensities of the connections when the synaptic currents are summed
+   *  @return 1, unless the connections are shared with a network of another mean intensity (see \ref Network(const Network&, double, double, Random&))
+   */
+  double getScale() const;
+
+  /*! @brief Getter for the spikes of the last update, as a bitmask.
+   *  The bit i%64 of the word i/64 is set when the neuron i fired.
+   *  @return the words of the bitmask
+   */
+  const std::vector<uint64_t>& getSpikes() const;
+
+  /*! @brief Getter for the way synaptic currents are computed ('s' or 'e')*/
+  char getPropagation() const;
+
+  /*! @brief Getter for the runs of consecutive neurons of the same type, in the order of the neurons.
+   *  The currents of the neurons of each run are computed by a loop specialised on their type, whose constants are known at compile time.
+   */
+  const std::vector<TypeBlock>& getBlocks() const;
+
+  /*! @brief Getter for the list of neurons which fired at the last update in event mode
+   *  @return the indices of these neurons, in increasing order
+   */
+  const std::vector<int>& getFired() const;
+
   /*! @brief Calculates the synaptic current received by the neurons, and sets the new current.
   * @param index The index of the neuron for which we want to caculate the total current.
   */
@@ -80,10 +298,15 @@ public:
     */
   std::vector<Neuron*> getNet() const;
 
+  /*! @brief Getter for the state store of the neurons in the network
+    * @return the pool in which the parameters and variables of all neurons are stored
+    */
+  const NeuronPool& getNeurons() const;
+
   /*! @brief Getter for the connections of neurons in the network
-   *  @return the vector of connections of the network
+   *  @return the matrix of connections of the network, row i holding the connections received by the neuron i
    */
-  std::vector<std::map<Neuron*, double>> getCon() const;
+  const SynapseMatrix& getCon() const;
 
   /*! @brief Getter for one neuron of each type, putting it in a list  
    *  @note The order of the type of neurons is "FS", "LTS", "IB", "RZ", "TC", "CH", "RS"
@@ -99,19 +322,158 @@ public:
   double getValence(int index) const;
 
 private:
-  ///Collection of all neurons of the network
+  /*! @brief Initializes the connections with the construction chosen
+   *  @param lambda the mean connectivity between neurons
+   *  @param construction 's' for \ref makeConnections(double, Random&) or 'p' for \ref makeConnections(double, uint64_t, size_t)
+   *  @note Both draw from the substream \ref Random::TOPOLOGY of the generator, so that the connections do not depend on the parameters drawn for the neurons
+   *  @param threads the number of threads of the parallel construction
+   */
+  void connect(double lambda, char construction, size_t threads);
+
+  /*! @brief Builds the runs of consecutive neurons of the same type (see \ref getBlocks)*/
+  void makeBlocks();
+
+  /*! @brief Sum of the intensities of the connections a neuron receives from the firing neurons*/
+  double synapticInput(int index) const;
+
+  /*! @brief Asynchronous update of the neurons of a block, by the loop specialised on its type if its neurons have the constants of their type*/
+  void updateBlock(const TypeBlock& block);
+
+  /*! @brief Asynchronous update of consecutive neurons of type T, the amplitude of their noise being a constant*/
+  template<NeuronType T> void updateBlock(int begin, int end);
+
+  /*! @brief Sets the currents of the neurons of a block within a range in synchronous mode, from their noise and their synaptic inputs
+   *  @param block the block
+   *  @param begin,end the neurons of the block whose current is set
+   */
+  void setCurrents(const TypeBlock& block, int begin, int end);
+
+  /*! @brief Sets the currents of consecutive neurons of type T in synchronous mode, the amplitude of their noise being a constant*/
+  template<NeuronType T> void setCurrents(int begin, int end);
+
+  /*! @brief Updates all neurons from the spikes of the previous step*/
+  void updateSynchronous();
+
+  /*! @brief Computes the inputs of one range of neurons from the spikes of the previous step, and updates them
+   *  @param range the index of the range in \ref _ranges
+   */
+  void updateRange(size_t range);
+
+  /*! @brief Sums the synaptic inputs of a range of neurons in synchronous mode: by a scan, by events, or through the delays
+   *  @param begin,end the range of neurons
+   *  @param weights the intensities of the connections of the matrix walked (\ref _outgoing in event mode, \ref _connections otherwise), in the chosen precision
+   *  @param unit the factor converting them to intensities
+   */
+  template<class W> void sumInputs(int begin, int end, const W* weights, double unit);
+
+  /*! @brief Adds the spikes of the last update to the inputs of the neurons of a range at the steps they arrive, and takes the inputs arriving now
+   *  @param begin,end the range of neurons
+   *  @param weights,unit the intensities, as for \ref sumInputs
+   */
+  template<class W> void deliverDelayed(int begin, int end, const W* weights, double unit);
+
+  /*! @brief Resets the buffers and the noise streams used by the chosen update*/
+  void prepare();
+
+  /*! @brief Sets the spikes bitmask from the current firing state of the neurons*/
+  void resetSpikes();
+
+  /*! @brief Reads the bit of a neuron in a spikes bitmask*/
+  static bool getSpike(const std::vector<uint64_t>& spikes, size_t index) {return (spikes[index >> 6] >> (index & 63)) & 1;};
+
+  /*! @brief Writes the bit of a neuron in a spikes bitmask*/
+  static void setSpike(std::vector<uint64_t>& spikes, size_t index, bool fired) {
+    const uint64_t bit(uint64_t(1) << (index & 63));
+    spikes[index >> 6] = fired ? (spikes[index >> 6] | bit) : (spikes[index >> 6] & ~bit);
+  };
+
+  ///Generator of the parameters, the connections and the noise, given at the construction
+  Random* _random;
+
+  ///State of all neurons of the network, stored contiguously
+  NeuronPool _neurons;
+
+  ///Runs of consecutive neurons of the same type
+  std::vector<TypeBlock> _blocks;
+
+  ///Original index of each neuron, empty unless the network was reordered
+  std::vector<int> _order;
+
+  ///Collection of views on the neurons of the network, in the order of the pool
   std::vector<Neuron*> _network;
 
-  ///Collection of connections to the neurons of corresponding index.
-  ///The second parameter of the map is the intensity of the connection.
-  std::vector<std::map<Neuron*, double>> _connections;
+  ///Connections to the neurons of corresponding row, with the intensity of each connection.
+  SynapseMatrix _connections;
 
   ///The mean intensity for the connections
   double _intensity;
 
+  ///Factor applied to the intensities of \ref _connections, 1 unless they are shared with a network of another mean intensity
+  double _scale;
+
   ///The model of the simulation
   char _model;
 
+  ///The way synaptic currents are computed, 's' for scan and 'e' for event
+  char _propagation;
+
+  ///Tells if all neurons read the spikes of the previous step
+  bool _synchronous;
+
+  ///Spikes of the last update, one bit per neuron
+  std::vector<uint64_t> _spikes;
+
+  ///Spikes being written by the current synchronous update, swapped with \ref _spikes at the end of the step
+  std::vector<uint64_t> _nextSpikes;
+
+  ///Connections made by the neurons of corresponding row, only built in event mode
+  SynapseMatrix _outgoing;
+
+  ///Neurons which fired at the last update, in event mode
+  std::vector<int> _fired;
+
+  ///Synaptic inputs of the neurons, in synchronous mode
+  std::vector<double> _input;
+
+  ///Standard normal noise of the neurons for the current step, drawn for all of them at once
+  std::vector<double> _noise;
+
+  ///Noise drawn in the original order of the neurons of a reordered network, each neuron reading the one of its original index
+  std::vector<double> _drawn;
+
+  ///Seed of the noise streams of the neurons in synchronous mode, drawn the first time this mode is chosen
+  uint64_t _noiseSeed;
+
+  ///Number of updates done in synchronous mode, used as counter of the noise streams
+  uint64_t _step;
+
+  ///Delay of each connection of \ref _outgoing, in steps, empty without delays
+  std::vector<uint16_t> _delays;
+
+  ///Largest delay, 0 without delays
+  int _maxDelay;
+
+  ///Seed of the delays
+  uint64_t _delaySeed;
+
+  ///Inputs on their way to the neurons, the slot s % _maxDelay of N inputs being the ones arriving at the step s
+  std::vector<double> _delayed;
+
+  ///Precision of the intensities and of the state read by the synchronous update, 'd', 'f' or 'h'
+  char _precision;
+
+  ///Largest rounding of an intensity by the last change of precision
+  double _weightError;
+
+  ///Threads updating the network in synchronous mode
+  std::unique_ptr<ThreadPool> _threads;
+
+  ///Bounds of the ranges of neurons updated by each thread
+  std::vector<int> _ranges;
+
+  ///Neurons of each range which fired at the last update
+  std::vector<std::vector<int>> _rangeFired;
+
   ///One neuron of each type present in the simulation to compute the output graphs
   ///The order is FS, LTS, IB, RZ, TC, CH, RS
   std::array<Neuron*,7> _neuronsforoutputs; 
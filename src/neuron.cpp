@@ -1,40 +1,28 @@
 #include "neuron.hpp"
-#include "constants.hpp"
 
-Neuron::Neuron(std::string type)
-: _current(0.0), _type(type)
+Neuron::Neuron(NeuronPool& pool, size_t index)
+: _pool(&pool), _index(index)
 {}
 
-Neuron::~Neuron()
-{}
-
-void Neuron::update()
+Neuron::Neuron(std::string type, double w, double factor, NeuronPool* pool)
+: _pool(pool)
 {
-    if(isFiring()){
-        _v = _c;
-        _u += _d;
-    } 
-    else {
-        //based on Izhikevich model, we have to udpate the v twice more often than the u.
-        _v += (0.5*(0.04*_v*_v + 5*_v + 140 - _u + _current));
-        _v += (0.5*(0.04*_v*_v + 5*_v + 140 - _u + _current));
-        _u += (_a*(_b*_v - _u));
+    if (_pool == nullptr) {
+        _ownPool.reset(new NeuronPool());
+        _pool = _ownPool.get();
     }
+    _index = _pool->add(type, w, factor);
 }
 
-bool Neuron::isFiring(){
-    if(_v >= _DISCHARGE_T_){
-        _v = _DISCHARGE_T_;
-        return true;
-    }
-    return false;
-}
-std::vector<double> Neuron::getAttributs(){
-    return {_a, _b, _c, _d};
+Neuron::~Neuron()
+{}
+
+std::vector<double> Neuron::getAttributs() const {
+    return _pool->getAttributs(_index);
 }
-std::vector<double> Neuron::getVariables(){
-    return {_v, _u, _current};
+std::vector<double> Neuron::getVariables() const {
+    return _pool->getVariables(_index);
 }
 std::string Neuron::getType() const{
-    return _type;
-} 
\ No newline at end of file
+    return _pool->getType(_index);
+} 
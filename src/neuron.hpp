@@ -2,25 +2,29 @@
 #define NEURON_HPP
 #include <vector>
 #include <string>
+#include <memory>
 #include "random.hpp"
+#include "neuronPool.hpp"
 
 
 /**
- * @brief A pure virtual class Neuron.
+ * @brief A class Neuron.
  * 
  * Class defined by 4 dimensionless parameters a,b,c,d. 
  * 2 systems of ordinary differential equations of who's variables are v,u
  * and the current from the network it belongs to.
+ * The parameters and variables are stored in a \ref NeuronPool, the Neuron being a view on one of its entries.
  */
 
 class Neuron{
     public:
     /**
-     * @brief Constructs a new Neuron object
+     * @brief Constructs a view on a neuron already stored in a pool
      * 
-     * @param type is a string indicating the type of the Neuron 
+     * @param pool the pool containing the neuron
+     * @param index the index of the neuron in the pool
      */
-    Neuron(std::string type);
+    Neuron(NeuronPool& pool, size_t index);
 
     /**
      * @brief Destroys the Neuron object
@@ -33,56 +37,57 @@ class Neuron{
     * Update is 1 simulation step. It updates the paramters of the Neuron using the correct
     * forumla, depending on the firing state of the Neuron
     */
-    void update();
+    void update() {_pool->update(_index);};
 
     /**
      * @brief Sets the current paramter
      * 
      * @param current is the new current value
      */
-    void setCurrent(const double current) {_current = current;};
+    void setCurrent(const double current) {_pool->setCurrent(_index, current);};
     
     
     /**
      * @brief Computes the noise produced by the neuron using normal distribution
      * 
+     * @param random the generator of the noise
      * @return The noise produced by the neuron
      */
-    double noise() const {return getW() * (_RNG->normal(0,1));}; 
+    double noise(Random& random) const {return _pool->noise(_index, random);};
     /**
      * @brief Describes the firing state of the neuron
      *
      * @return true when v passes the threshold
      * @return false when v is under the threshold
      */
-    bool isFiring();
+    bool isFiring() const {return _pool->isFiring(_index);};
 
     /**
      * @brief Getter for the _a, _b, _c, _d attributes
      * 
      * @return std::vector<double> {_a, _b, _c, _d}
      */
-    std::vector<double> getAttributs();
+    std::vector<double> getAttributs() const;
     /**
      * @brief Getter for the _v, _u,  _current variables
      * 
      * @return std::vector<double> {_v, _u, _current}
      */
-    std::vector<double> getVariables();
+    std::vector<double> getVariables() const;
 
     /**
      * @brief Getter for the W of the neuron
      * 
      * @return the w of the neuron
      */
-    virtual double getW() const = 0;
+    double getW() const {return _pool->getW(_index);};
 
     /**
-     * @brief Pure virtual method returning the factor of the neuron
+     * @brief Getter for the factor of the neuron
      * 
      * @return the factor of the neuron
      */
-    virtual double factor() const = 0;
+    double factor() const {return _pool->factor(_index);};
 
     /**
      * @brief Getter for the type of the neuron
@@ -91,23 +96,28 @@ class Neuron{
     std::string getType() const; 
 
 
+    /**
+     * @brief Getter for the index of the neuron in its pool
+     */
+    size_t getIndex() const {return _index;};
+
 protected:
-    ///describes the time scale of the recovery variable u.
-    double _a; 
-    ///describes the sensitivity of the recovery variable u to the subthreshold of the fluctuation of membrane potential v.
-    double _b; 
-    ///describes the after-spike reset value of the membrane potential v.
-    double _c; 
-    ///describes the after-spike reset of the recovery variable u.
-    double _d; 
-    ///membrane potential of the neuron
-    double _v; 
-    ///membrane recovery variable 
-    double _u; 
-    ///synaptic current delivered by surrounding neurons
-    double _current; 
-    ///type depending on the pattern of spiking and bursting
-    std::string _type; 
+    /**
+     * @brief Constructs a new Neuron object, appended to a pool
+     * 
+     * @param type is a string indicating the type of the Neuron 
+     * @param w the amplitude of the noise of the Neuron
+     * @param factor the factor applied to the connections made by the Neuron
+     * @param pool the pool in which the Neuron is stored, a pool of its own is created if it is a nullptr
+     */
+    Neuron(std::string type, double w, double factor, NeuronPool* pool);
+
+    ///pool in which the parameters and variables of the neuron are stored
+    NeuronPool* _pool;
+    ///index of the neuron in the pool
+    size_t _index;
+    ///pool owned by a neuron which was created outside of any network
+    std::unique_ptr<NeuronPool> _ownPool;
 };
 
 
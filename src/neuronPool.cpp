@@ -0,0 +1,148 @@
+#include "neuronPool.hpp"
+#include <algorithm>
+#include <stdexcept>
+
+NeuronPool::NeuronPool()
+    : _single(false), _kernel(integrationKernel()), _kernel32(integrationKernel32())
+{}
+
+size_t NeuronPool::add(const std::string& type, double w, double factor) {
+    const NeuronType found(neuronType(type));
+    if (_single) {
+        const float state[7] = {0, 0, 0, 0, _INIT_V_, 0, 0};
+        for (size_t k(0); k < _state32.size(); ++k) {
+            _state32[k].push_back(state[k]);
+        }
+    }
+    else {
+        _a.push_back(0);
+        _b.push_back(0);
+        _c.push_back(0);
+        _d.push_back(0);
+        _v.push_back(_INIT_V_);
+        _u.push_back(0);
+        _current.push_back(0.0);
+    }
+    _w.push_back(w);
+    _factor.push_back(factor);
+    _type.push_back((unsigned char)found);
+    return _type.size() - 1;
+}
+
+void NeuronPool::setAttributs(size_t index, double a, double b, double c, double d) {
+    if (_single) {
+        _state32[0][index] = a;
+        _state32[1][index] = b;
+        _state32[2][index] = c;
+        _state32[3][index] = d;
+        _state32[4][index] = _INIT_V_;
+        _state32[5][index] = _state32[1][index]*_state32[4][index];
+        return;
+    }
+    _a[index] = a;
+    _b[index] = b;
+    _c[index] = c;
+    _d[index] = d;
+    _v[index] = _INIT_V_;
+    _u[index] = b*_v[index];
+}
+
+std::vector<double> NeuronPool::getAttributs(size_t index) const {
+    if (_single) {
+        return {_state32[0][index], _state32[1][index], _state32[2][index], _state32[3][index]};
+    }
+    return {_a[index], _b[index], _c[index], _d[index]};
+}
+
+std::vector<double> NeuronPool::getVariables(size_t index) const {
+    if (_single) {
+        return {_state32[4][index], _state32[5][index], _state32[6][index]};
+    }
+    return {_v[index], _u[index], _current[index]};
+}
+
+void NeuronPool::setVariables(size_t index, double v, double u, double current) {
+    if (_single) {
+        _state32[4][index] = v;
+        _state32[5][index] = u;
+        _state32[6][index] = current;
+        return;
+    }
+    _v[index] = v;
+    _u[index] = u;
+    _current[index] = current;
+}
+
+std::string NeuronPool::getType(size_t index) const {
+    return TYPE_TRAITS[_type[index]].name;
+}
+
+void NeuronPool::reserve(size_t nb) {
+    if (_single) {
+        for (auto& array: _state32) {
+            array.reserve(nb);
+        }
+    }
+    else {
+        _a.reserve(nb);
+        _b.reserve(nb);
+        _c.reserve(nb);
+        _d.reserve(nb);
+        _v.reserve(nb);
+        _u.reserve(nb);
+        _current.reserve(nb);
+    }
+    _w.reserve(nb);
+    _factor.reserve(nb);
+    _type.reserve(nb);
+}
+
+std::array<const double*, NeuronPool::COLUMNS> NeuronPool::columns() const {
+    return {{_a.data(), _b.data(), _c.data(), _d.data(), _v.data(), _u.data(), _current.data(), _w.data(), _factor.data()}};
+}
+
+std::vector<double> NeuronPool::column(size_t index) const {
+    if (_single and index < _state32.size()) {
+        return std::vector<double>(_state32[index].begin(), _state32[index].end());
+    }
+    return std::vector<double>(columns()[index], columns()[index] + size());
+}
+
+void NeuronPool::assign(size_t nb, const unsigned char* types, const std::array<const double*, COLUMNS>& columns) {
+    if (std::any_of(types, types + nb, [](unsigned char type) {return type >= NEURON_TYPES;})) {
+        throw std::domain_error("A neuron has an unknown type");
+    }
+    _type.assign(types, types + nb);
+    std::vector<double>* arrays[COLUMNS] = {&_a, &_b, &_c, &_d, &_v, &_u, &_current, &_w, &_factor};
+    for (size_t k(0); k < COLUMNS; ++k) {
+        if (_single and k < _state32.size()) {
+            _state32[k].assign(columns[k], columns[k] + nb);
+        }
+        else {
+            arrays[k]->assign(columns[k], columns[k] + nb);
+        }
+    }
+}
+
+void NeuronPool::setSinglePrecision(bool single) {
+    if (single == _single) {
+        return;
+    }
+    std::vector<double>* arrays[7] = {&_a, &_b, &_c, &_d, &_v, &_u, &_current};
+    for (size_t k(0); k < _state32.size(); ++k) {
+        if (single) {
+            _state32[k].assign(arrays[k]->begin(), arrays[k]->end());
+            std::vector<double>().swap(*arrays[k]);
+        }
+        else {
+            arrays[k]->assign(_state32[k].begin(), _state32[k].end());
+            std::vector<float>().swap(_state32[k]);
+        }
+    }
+    _single = single;
+}
+
+void NeuronPool::setKernel(const std::string& name) {
+    _kernel = integrationKernel(name);
+    _kernel32 = integrationKernel32(name);
+}
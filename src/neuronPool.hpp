@@ -0,0 +1,239 @@
+#ifndef NEURONPOOL_HPP
+#define NEURONPOOL_HPP
+#include <vector>
+#include <array>
+#include <string>
+#include <cstddef>
+#include "constants.hpp"
+#include "random.hpp"
+#include "kernels.hpp"
+#include "neuronTypes.hpp"
+
+
+/**
+ * @brief Contiguous state store for a set of neurons.
+ *
+ * Each attribute (a, b, c, d), variable (v, u, current) and type constant (w, factor)
+ * is kept in its own array indexed by the position of the neuron in the pool,
+ * so that one simulation step walks every array once, from the first neuron to the last.
+ * The attributes and variables can be stored in float instead (see \ref setSinglePrecision), halving the memory read by a step.
+ * A \ref Neuron object is a view on one index of a pool.
+ */
+class NeuronPool {
+
+public:
+    /**
+     * @brief Constructs an empty pool, updated by the fastest kernel available on the processor
+     */
+    NeuronPool();
+
+    /**
+     * @brief Appends a new neuron to the pool
+     *
+     * The attributes are set to zero and have to be given with \ref setAttributs.
+     * @param type the type of the neuron ("FS", "LTS", "IB", "RZ", "TC", "CH" or "RS")
+     * @param w the amplitude of the noise of the neuron
+     * @param factor the factor applied to the connections made by the neuron
+     * @return the index of the new neuron in the pool
+     */
+    size_t add(const std::string& type, double w, double factor);
+
+    /**
+     * @brief Sets the attributes of a neuron and puts it back at rest (v = _INIT_V_, u = b*v)
+     * @param index the index of the neuron in the pool
+     * @param a,b,c,d the new attributes
+     */
+    void setAttributs(size_t index, double a, double b, double c, double d);
+
+    /**
+     * @brief Updates one neuron for 1 simulation step
+     *
+     * Same formula as \ref Neuron::update, applied to the neuron at the given index.
+     * A membrane potential passing the threshold is brought back to it, so that it is read as firing until the next update.
+     * @param index the index of the neuron in the pool
+     */
+    void update(size_t index);
+
+    /**
+     * @brief Updates a range of neurons for 1 simulation step, several neurons at once with the kernel of the pool
+     *
+     * Gives the same result as \ref update(size_t) called on each neuron of the range.
+     * @param begin the index of the first neuron, a multiple of 64
+     * @param end the index following the last neuron
+     * @param spikes the words of a bitmask for the range, in which the firing state after the update is written
+     */
+    void update(size_t begin, size_t end, uint64_t* spikes);
+
+    /**
+     * @brief Chooses the kernel used to update ranges of neurons
+     * @param name the name of the kernel (see \ref availableKernels), or an empty string for the fastest one
+     */
+    void setKernel(const std::string& name);
+
+    /**
+     * @brief Chooses the precision in which the attributes a, b, c, d and the variables v, u, current are stored and integrated
+     *
+     * In single precision, they are rounded to float and the arrays of doubles are released; going back to double keeps the rounded values.
+     * The type constants w and factor stay in double.
+     * @param single true for float, false for double
+     */
+    void setSinglePrecision(bool single);
+
+    /**
+     * @brief Tells if the attributes and variables are stored in float
+     */
+    bool isSinglePrecision() const {return _single;};
+
+    /**
+     * @brief Describes the firing state of a neuron
+     * @param index the index of the neuron in the pool
+     * @return true when v reached the threshold
+     */
+    bool isFiring(size_t index) const {return (_single ? _state32[4][index] : _v[index]) >= _DISCHARGE_T_;};
+
+    /**
+     * @brief Computes the noise produced by a neuron using normal distribution
+     * @param index the index of the neuron in the pool
+     * @param random the generator of the noise
+     * @return the noise produced by the neuron
+     */
+    double noise(size_t index, Random& random) const {return _w[index] * (random.normal(0,1));};
+
+    /**
+     * @brief Sets the current of a neuron
+     * @param index the index of the neuron in the pool
+     * @param current the new current value
+     */
+    void setCurrent(size_t index, const double current) {
+        if (_single) _state32[6][index] = current;
+        else _current[index] = current;
+    };
+
+    /**
+     * @brief Getter for the _a, _b, _c, _d attributes of a neuron
+     * @return std::vector<double> {a, b, c, d}
+     */
+    std::vector<double> getAttributs(size_t index) const;
+
+    /**
+     * @brief Getter for the _v, _u, _current variables of a neuron
+     * @return std::vector<double> {v, u, current}
+     */
+    std::vector<double> getVariables(size_t index) const;
+
+    /**
+     * @brief Sets the _v, _u, _current variables of a neuron, for instance to restore a saved state
+     */
+    void setVariables(size_t index, double v, double u, double current);
+
+    /**
+     * @brief Getter for the w of a neuron
+     */
+    double getW(size_t index) const {return _w[index];};
+
+    /**
+     * @brief Getter for the factor of a neuron
+     */
+    double factor(size_t index) const {return _factor[index];};
+
+    /**
+     * @brief Getter for the type of a neuron
+     */
+    std::string getType(size_t index) const;
+
+    /**
+     * @brief Getter for the type of a neuron, as used by the kernels specialised on the type
+     */
+    NeuronType typeOf(size_t index) const {return NeuronType(_type[index]);};
+
+    /**
+     * @brief Number of neurons in the pool
+     */
+    size_t size() const {return _type.size();};
+
+    /**
+     * @brief Reserves memory for a given number of neurons
+     * @param nb the number of neurons the pool will contain
+     */
+    void reserve(size_t nb);
+
+    ///Number of arrays of doubles of a pool
+    static const size_t COLUMNS = 9;
+
+    /**
+     * @brief The arrays of doubles of the pool, for instance to read them in place
+     * @return the arrays a, b, c, d, v, u, current, w and factor, of size() elements each
+     * @note In single precision, the first 7 arrays are empty and their pointers are not valid, see \ref column
+     */
+    std::array<const double*, COLUMNS> columns() const;
+
+    /**
+     * @brief Copy in double of one of the arrays of the pool, whatever its precision, for instance to save it
+     * @param index the index of the array in \ref columns
+     */
+    std::vector<double> column(size_t index) const;
+
+    /**
+     * @brief The types of all neurons, as indices in \ref NeuronType
+     */
+    const unsigned char* types() const {return _type.data();};
+
+    /**
+     * @brief Replaces all neurons of the pool by copies of saved ones
+     * @param nb the number of neurons
+     * @param types the types of the neurons, as indices in \ref NeuronType
+     * @param columns the arrays a, b, c, d, v, u, current, w and factor, of nb elements each
+     * @note Throws a domain error if a type is not in \ref NeuronType. The pool keeps its precision.
+     */
+    void assign(size_t nb, const unsigned char* types, const std::array<const double*, COLUMNS>& columns);
+
+private:
+    ///time scales of the recovery variables u
+    std::vector<double> _a;
+    ///sensitivities of the recovery variables u
+    std::vector<double> _b;
+    ///after-spike reset values of the membrane potentials v
+    std::vector<double> _c;
+    ///after-spike resets of the recovery variables u
+    std::vector<double> _d;
+    ///membrane potentials
+    std::vector<double> _v;
+    ///membrane recovery variables
+    std::vector<double> _u;
+    ///synaptic currents delivered by the surrounding neurons
+    std::vector<double> _current;
+    ///amplitudes of the noise
+    std::vector<double> _w;
+    ///factors applied to the outgoing connections
+    std::vector<double> _factor;
+    ///types, as indices in \ref NeuronType
+    std::vector<unsigned char> _type;
+    ///tells if the attributes and variables are stored in \ref _state32 instead of their arrays of doubles
+    bool _single;
+    ///a, b, c, d, v, u and current in float, in the order of \ref columns, empty in double precision
+    std::array<std::vector<float>, 7> _state32;
+    ///kernel updating ranges of neurons
+    IntegrationKernel _kernel;
+    ///kernel updating ranges of neurons in single precision
+    IntegrationKernel32 _kernel32;
+};
+
+inline void NeuronPool::update(size_t index) {
+    if (_single) {
+        integrateNeuron(_state32[0][index], _state32[1][index], _state32[2][index], _state32[3][index],
+                        _state32[4][index], _state32[5][index], _state32[6][index]);
+        return;
+    }
+    integrateNeuron(_a[index], _b[index], _c[index], _d[index], _v[index], _u[index], _current[index]);
+}
+
+inline void NeuronPool::update(size_t begin, size_t end, uint64_t* spikes) {
+    if (_single) {
+        _kernel32(end - begin, &_state32[0][begin], &_state32[1][begin], &_state32[2][begin], &_state32[3][begin],
+                  &_state32[4][begin], &_state32[5][begin], &_state32[6][begin], spikes);
+        return;
+    }
+    _kernel(end - begin, &_a[begin], &_b[begin], &_c[begin], &_d[begin], &_v[begin], &_u[begin], &_current[begin], spikes);
+}
+
+#endif //NEURONPOOL_HPP
@@ -0,0 +1,73 @@
+#ifndef NEURONTYPES_HPP
+#define NEURONTYPES_HPP
+#include <string>
+#include <stdexcept>
+#include <cstddef>
+#include "constants.hpp"
+
+
+/**
+ * @brief Types of neurons, in the order of the type indices of a \ref NeuronPool
+ */
+enum class NeuronType : unsigned char {FS, LTS, IB, RZ, TC, CH, RS};
+
+///Number of types of neurons
+const size_t NEURON_TYPES = 7;
+
+/**
+ * @brief Constants of a type of neuron: its name, its kind, the amplitude of its noise,
+ * the factor of the connections it makes, and the nominal attributes a, b, c, d,
+ * around which the attributes of each neuron are drawn.
+ */
+struct TypeTraits {
+    const char* name;
+    bool excitatory;
+    double w;
+    double factor;
+    double a, b, c, d;
+};
+
+///Constants of the types of neurons, known at compile time, in the order of \ref NeuronType
+constexpr TypeTraits TYPE_TRAITS[NEURON_TYPES] = {
+    {"FS", false, _INHIB_W_, _INHIB_FACTOR_, _FS_A_, _FS_B_, _FS_C_, _FS_D_},
+    {"LTS", false, _INHIB_W_, _INHIB_FACTOR_, _LTS_A_, _LTS_B_, _LTS_C_, _LTS_D_},
+    {"IB", true, _EXCIT_W_, _EXCIT_FACTOR_, _IB_A_, _IB_B_, _IB_C_, _IB_D_},
+    {"RZ", true, _EXCIT_W_, _EXCIT_FACTOR_, _RZ_A_, _RZ_B_, _RZ_C_, _RZ_D_},
+    {"TC", true, _EXCIT_W_, _EXCIT_FACTOR_, _TC_A_, _TC_B_, _TC_C_, _TC_D_},
+    {"CH", true, _EXCIT_W_, _EXCIT_FACTOR_, _CH_A_, _CH_B_, _CH_C_, _CH_D_},
+    {"RS", true, _EXCIT_W_, _EXCIT_FACTOR_, _RS_A_, _RS_B_, _RS_C_, _RS_D_}
+};
+
+/**
+ * @brief Constants of a type of neuron, as a compile-time constant for the kernels specialised on the type
+ */
+constexpr const TypeTraits& typeTraits(NeuronType type) {
+    return TYPE_TRAITS[size_t(type)];
+}
+
+/**
+ * @brief Finds a type of neuron by its name
+ * @note Throws a domain error if there is no type of this name
+ */
+inline NeuronType neuronType(const std::string& name) {
+    for (size_t type(0); type < NEURON_TYPES; ++type) {
+        if (name == TYPE_TRAITS[type].name) return NeuronType(type);
+    }
+    throw std::domain_error("The " + name + " neuron does not exist");
+}
+
+
+/**
+ * @brief A run of consecutive neurons of the same type in a pool, updated by the kernels specialised on this type
+ */
+struct TypeBlock {
+    NeuronType type;
+    ///index of the first neuron
+    int begin;
+    ///index following the last neuron
+    int end;
+    ///tells if all neurons have the noise amplitude of their type, so that it is used as a constant
+    bool traits;
+};
+
+#endif //NEURONTYPES_HPP
@@ -0,0 +1,80 @@
+#include "outputQueue.hpp"
+#include <chrono>
+#include <stdexcept>
+
+OutputQueue::OutputQueue(size_t capacity, const std::function<void(const OutputFrame&)>& consume)
+    : _frames(capacity), _consume(consume), _tail(0), _head(0), _closed(false)
+{
+    if (capacity == 0) {
+        throw std::domain_error("The output queue needs at least one frame");
+    }
+    _thread = std::thread(&OutputQueue::work, this);
+}
+
+OutputQueue::~OutputQueue() {
+    if (_thread.joinable()) {
+        _closed.store(true, std::memory_order_release);
+        _thread.join();
+    }
+}
+
+OutputFrame& OutputQueue::acquire() {
+    const size_t tail(_tail.load(std::memory_order_relaxed));
+    unsigned spins(0);
+    while (tail - _head.load(std::memory_order_acquire) == _frames.size()) {
+        pause(spins);
+    }
+    return _frames[tail % _frames.size()];
+}
+
+void OutputQueue::publish() {
+    _tail.store(_tail.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+}
+
+void OutputQueue::close() {
+    if (_thread.joinable()) {
+        _closed.store(true, std::memory_order_release);
+        _thread.join();
+    }
+    if (_error) {
+        std::exception_ptr error(_error);
+        _error = nullptr;
+        std::rethrow_exception(error);
+    }
+}
+
+void OutputQueue::work() {
+    size_t head(_head.load(std::memory_order_relaxed));
+    unsigned spins(0);
+    while (true) {
+        //the closing flag is read before the tail, so that no frame published before closing is missed
+        const bool closed(_closed.load(std::memory_order_acquire));
+        const size_t tail(_tail.load(std::memory_order_acquire));
+        if (head == tail) {
+            if (closed) return;
+            pause(spins);
+            continue;
+        }
+        spins = 0;
+        for (; head != tail; ++head) {
+            if (not _error) {
+                try {
+                    _consume(_frames[head % _frames.size()]);
+                } catch (...) {
+                    _error = std::current_exception();
+                }
+            }
+            _head.store(head + 1, std::memory_order_release);
+        }
+    }
+}
+
+void OutputQueue::pause(unsigned& spins) {
+    if (spins < 64) {
+        spins += 1;
+        std::this_thread::yield();
+    }
+    else {
+        std::this_thread::sleep_for(std::chrono::microseconds(50));
+    }
+}
@@ -0,0 +1,81 @@
+#ifndef OUTPUTQUEUE_HPP
+#define OUTPUTQUEUE_HPP
+#include <vector>
+#include <thread>
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <exception>
+#include <cstddef>
+#include <cstdint>
+#include "checkpoint.hpp"
+
+
+/**
+ * @brief Output of one simulation step, handed from the simulation loop to the writer thread.
+ */
+struct OutputFrame {
+    ///index of the step, starting at 1
+    int step;
+    ///bitmask of the neurons which fired, as given by \ref Network::getSpikes
+    std::vector<uint64_t> spikes;
+    ///sampled variables of the neurons, if any
+    std::vector<double> samples;
+    ///checkpoint to write once this step is written, if any
+    std::shared_ptr<Checkpoint> checkpoint;
+};
+
+
+/**
+ * @brief Bounded lock-free queue between one producer (the simulation loop) and one writer thread.
+ *
+ * The frames are allocated once and reused, so that handing a step to the writer only copies its buffers.
+ * The producer waits when all frames are waiting to be written (backpressure),
+ * and the writer waits when there is no frame to write.
+ */
+class OutputQueue {
+
+public:
+    /*! @brief Starts the writer thread
+     *  @param capacity the number of frames of the queue
+     *  @param consume the function writing a frame, called by the writer thread in the order of the frames
+     */
+    OutputQueue(size_t capacity, const std::function<void(const OutputFrame&)>& consume);
+
+    /*! @brief Writes the remaining frames and stops the writer thread*/
+    ~OutputQueue();
+
+    /*! @brief Gives the next free frame to fill, waiting for the writer if the queue is full
+     *  @note The frame is handed to the writer by \ref publish
+     */
+    OutputFrame& acquire();
+
+    /*! @brief Hands the frame given by \ref acquire to the writer thread*/
+    void publish();
+
+    /*! @brief Writes the remaining frames and stops the writer thread
+     *  @note The first exception thrown while writing a frame is thrown again here
+     */
+    void close();
+
+private:
+    /*! @brief Loop of the writer thread*/
+    void work();
+
+    /*! @brief Waits a little before checking the queue again: yields first, then sleeps*/
+    static void pause(unsigned& spins);
+
+    ///frames of the queue, frame k being used by the k-th step modulo the capacity
+    std::vector<OutputFrame> _frames;
+    std::function<void(const OutputFrame&)> _consume;
+    ///number of frames published by the producer
+    std::atomic<size_t> _tail;
+    ///number of frames written by the writer thread
+    std::atomic<size_t> _head;
+    std::atomic<bool> _closed;
+    ///first exception thrown while writing a frame, the next frames being dropped
+    std::exception_ptr _error;
+    std::thread _thread;
+};
+
+#endif //OUTPUTQUEUE_HPP
@@ -0,0 +1,63 @@
+#include "profiler.hpp"
+#include <algorithm>
+#include <iomanip>
+#include <numeric>
+
+const std::array<std::string, Profiler::PHASES> Profiler::PHASE_NAMES = {{"build", "current", "update", "print", "sample", "wait", "checkpoint", "parameters"}};
+const std::array<std::string, Profiler::COUNTERS> Profiler::COUNTER_NAMES = {{"steps", "spikes", "synaptic events", "bytes written"}};
+
+Profiler::Profiler()
+    : _enabled(false)
+{
+    for (auto& counter: _counters) {
+        counter = 0;
+    }
+}
+
+Profiler& Profiler::instance() {
+    static Profiler profiler;
+    return profiler;
+}
+
+void Profiler::record(Phase phase, double seconds) {
+    std::lock_guard<std::mutex> lock(_mutexes[phase]);
+    _times[phase].push_back(seconds);
+}
+
+std::vector<double> Profiler::getTimes(Phase phase) const {
+    std::lock_guard<std::mutex> lock(_mutexes[phase]);
+    return _times[phase];
+}
+
+void Profiler::report(std::ostream& out) const {
+    const double steps(std::max<uint64_t>(_counters[STEPS], 1));
+    out << std::left << std::setw(12) << "phase" << std::right << std::setw(10) << "calls" << std::setw(12) << "total (s)"
+        << std::setw(14) << "ms per step" << std::setw(12) << "p50 (ms)" << std::setw(12) << "p90 (ms)" << std::setw(12) << "p99 (ms)" << "\n";
+    out << std::fixed;
+    for (size_t phase(0); phase < PHASES; ++phase) {
+        std::vector<double> times(getTimes(Phase(phase)));
+        if (times.empty()) continue;
+        std::sort(times.begin(), times.end());
+        //nearest-rank percentile
+        auto percentile = [&times](double p) {return 1e3*times[std::min(times.size() - 1, size_t(p*times.size()))];};
+        const double total(std::accumulate(times.begin(), times.end(), 0.0));
+        out << std::left << std::setw(12) << PHASE_NAMES[phase] << std::right << std::setw(10) << times.size()
+            << std::setprecision(4) << std::setw(12) << total << std::setw(14) << 1e3*total/steps
+            << std::setw(12) << percentile(.5) << std::setw(12) << percentile(.9) << std::setw(12) << percentile(.99) << "\n";
+    }
+    out << std::defaultfloat;
+    for (size_t counter(0); counter < COUNTERS; ++counter) {
+        out << std::left << std::setw(16) << COUNTER_NAMES[counter] << std::right << std::setw(16) << _counters[counter]
+            << std::setw(16) << std::setprecision(6) << _counters[counter]/steps << " per step\n";
+    }
+}
+
+void Profiler::reset() {
+    for (size_t phase(0); phase < PHASES; ++phase) {
+        std::lock_guard<std::mutex> lock(_mutexes[phase]);
+        _times[phase].clear();
+    }
+    for (auto& counter: _counters) {
+        counter = 0;
+    }
+}
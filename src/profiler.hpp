@@ -0,0 +1,112 @@
+#ifndef PROFILER_HPP
+#define PROFILER_HPP
+#include <vector>
+#include <array>
+#include <string>
+#include <mutex>
+#include <atomic>
+#include <chrono>
+#include <ostream>
+#include <cstdint>
+
+
+/**
+ * @brief Timings and counters of the phases of a run, reported at its end.
+ *
+ * The phases are timed with a steady clock by \ref ScopedTimer, at most a few times per step.
+ * Each time is kept, so that the report gives the total, the mean per step and the percentiles of the calls of each phase.
+ * Recording is only done once the profiler is enabled, and is compiled out when PROFILING is not defined
+ * (see \ref PROFILE_SCOPE and \ref PROFILE_COUNT).
+ */
+class Profiler {
+
+public:
+    ///phases of a run
+    enum Phase {BUILD, CURRENT, UPDATE, PRINT, SAMPLE, WAIT, CHECKPOINT, PARAMETERS, PHASES};
+    ///counted quantities
+    enum Counter {STEPS, SPIKES, EVENTS, BYTES, COUNTERS};
+
+    /*! @brief The profiler of the program*/
+    static Profiler& instance();
+
+    /*! @brief Starts or stops the recording, the times already recorded being kept*/
+    void enable(bool enabled) {_enabled = enabled;};
+
+    /*! @brief Tells if the times are recorded*/
+    bool enabled() const {return _enabled;};
+
+    /*! @brief Records one call of a phase, from any thread
+     *  @param phase the phase
+     *  @param seconds the duration of the call
+     */
+    void record(Phase phase, double seconds);
+
+    /*! @brief Adds to a counter, from any thread*/
+    void count(Counter counter, uint64_t n) {_counters[counter] += n;};
+
+    /*! @brief Getter for a counter*/
+    uint64_t getCount(Counter counter) const {return _counters[counter];};
+
+    /*! @brief Getter for the durations of the calls of a phase, in seconds*/
+    std::vector<double> getTimes(Phase phase) const;
+
+    /*! @brief Writes a table of the phases which were recorded (calls, total, mean per step, percentiles of the calls) and of the counters*/
+    void report(std::ostream& out) const;
+
+    /*! @brief Forgets all times and counters*/
+    void reset();
+
+    ///names of the phases, in the order of \ref Phase
+    static const std::array<std::string, PHASES> PHASE_NAMES;
+    ///names of the counters, in the order of \ref Counter
+    static const std::array<std::string, COUNTERS> COUNTER_NAMES;
+
+private:
+    Profiler();
+
+    bool _enabled;
+    std::array<std::vector<double>, PHASES> _times;
+    mutable std::array<std::mutex, PHASES> _mutexes;
+    std::array<std::atomic<uint64_t>, COUNTERS> _counters;
+};
+
+
+/**
+ * @brief Records the time spent in a scope as one call of a phase, if the profiler is enabled.
+ */
+class ScopedTimer {
+
+public:
+    ScopedTimer(Profiler::Phase phase)
+        : _phase(phase), _enabled(Profiler::instance().enabled())
+    {
+        if (_enabled) _start = std::chrono::steady_clock::now();
+    };
+
+    ~ScopedTimer() {
+        if (_enabled) {
+            Profiler::instance().record(_phase, std::chrono::duration<double>(std::chrono::steady_clock::now() - _start).count());
+        }
+    };
+
+private:
+    Profiler::Phase _phase;
+    bool _enabled;
+    std::chrono::steady_clock::time_point _start;
+};
+
+
+#ifdef PROFILING
+///Times the rest of the scope as one call of a phase of \ref Profiler
+#define PROFILE_SCOPE(phase) ScopedTimer profileScope(Profiler::phase)
+///Adds to a counter of \ref Profiler, the value being only computed when the profiler is enabled
+#define PROFILE_COUNT(counter, n) if (Profiler::instance().enabled()) Profiler::instance().count(Profiler::counter, (n))
+///Tells if the profiler is compiled and enabled
+#define PROFILE_ENABLED() Profiler::instance().enabled()
+#else
+#define PROFILE_SCOPE(phase)
+#define PROFILE_COUNT(counter, n)
+#define PROFILE_ENABLED() false
+#endif
+
+#endif //PROFILER_HPP
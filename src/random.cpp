@@ -1,11 +1,17 @@
 #include "random.hpp"
+#include <cmath>
+#include <sstream>
+#include <stdexcept>
 
 Random::Random(unsigned long int s) : _seed(s) {
     if (_seed == 0) {
         std::random_device rd;
         _seed = rd();
     }
-    _rng.seed(_seed);
+    //the engine only keeps 32 bits of an integer seed, so both halves of the seed go through a seed sequence
+    const uint64_t seed(_seed);
+    std::seed_seq sequence({uint32_t(seed), uint32_t(seed >> 32)});
+    _rng.seed(sequence);
 }
 
 double Random::exponential(const double rate) {
@@ -14,8 +20,7 @@ double Random::exponential(const double rate) {
 }
 
 double Random::normal(double mean, double sd) {
-	std::normal_distribution<> norm(mean, sd);
-	return norm(_rng);
+    return _normal(_rng) * sd + mean;
 }
 
 int Random::poisson(double mean) {
@@ -36,4 +41,63 @@ int Random::uniform_int (int lower, int upper) {
 bool Random::bernoulli(double p) {
     std::bernoulli_distribution bernou(p);
     return bernou(_rng);
-}
\ No newline at end of file
+}
+
+uint64_t Random::uniform_uint64() {
+    uint64_t high(_rng());
+    return (high << 32) | _rng();
+}
+
+Random Random::substream(uint64_t stream) const {
+    //a seed of 0 would be replaced by one drawn from the random_device
+    const unsigned long int seed(counter_hash(uint64_t(_seed), stream, 0));
+    return Random(seed == 0 ? 1 : seed);
+}
+
+std::string Random::getState() const {
+    std::ostringstream state;
+    state << _seed << ' ' << _rng << ' ' << _normal;
+    return state.str();
+}
+
+void Random::setState(const std::string& state) {
+    std::istringstream in(state);
+    if (not (in >> _seed >> _rng >> _normal)) {
+        throw std::runtime_error("The state of the random generator cannot be read");
+    }
+}
+
+double Random::counter_normal(uint64_t seed, uint64_t stream, uint64_t counter) {
+    //Box-Muller transform of the two uniform numbers of the pair of streams: the cosine for the even stream, the sine for the odd one
+    const uint64_t pair(stream >> 1);
+    const double radius(std::sqrt(-2.0 * std::log(counter_uniform(seed, pair, 2*counter))));
+    const double angle(6.283185307179586 * counter_uniform(seed, pair, 2*counter + 1));
+    return radius * ((stream & 1) ? std::sin(angle) : std::cos(angle));
+}
+
+void Random::counter_normals(uint64_t seed, uint64_t first, uint64_t counter, size_t n, double* out) {
+    //the pairs are drawn by blocks: the hashes first, in a loop without calls which can be vectorized, then the transforms
+    const size_t BLOCK(64);
+    double radius[BLOCK], angle[BLOCK];
+    size_t k(0);
+    if (n > 0 and (first & 1)) {
+        out[k++] = counter_normal(seed, first, counter);
+    }
+    while (k + 1 < n) {
+        const uint64_t pair((first + k) >> 1);
+        const size_t pairs(std::min(BLOCK, (n - k) / 2));
+        for (size_t j(0); j < pairs; j++) {
+            radius[j] = counter_uniform(seed, pair + j, 2*counter);
+            angle[j] = 6.283185307179586 * counter_uniform(seed, pair + j, 2*counter + 1);
+        }
+        for (size_t j(0); j < pairs; j++) {
+            const double r(std::sqrt(-2.0 * std::log(radius[j])));
+            out[k + 2*j] = r * std::cos(angle[j]);
+            out[k + 2*j + 1] = r * std::sin(angle[j]);
+        }
+        k += 2*pairs;
+    }
+    if (k < n) {
+        out[k] = counter_normal(seed, first + k, counter);
+    }
+}
@@ -3,7 +3,9 @@
 
 #include <random>
 #include <vector>
+#include <string>
 #include <algorithm>
+#include <cstdint>
 
 /*!
   @brief This is a Random number class based on standard c++-11 generators. 
@@ -15,7 +17,7 @@ class Random {
 public:
 /*! @name Initializing
   The generator \ref rng is a Mersenne twister *mt19937* engine. 
-  A seed *s>0* can be provided, by default it is seeded with a *random_device*.
+  A seed *s>0* can be provided, by default it is seeded with a *random_device*. All 64 bits of the seed are used, through a *seed_seq*.
 */
 ///@{
     Random(unsigned long int s = 0);
@@ -75,9 +77,69 @@ public:
      */
     bool bernoulli(double p = 0.5);
 
+    /**
+     * @brief Draws 64 random bits, typically used as the seed of counter-based streams
+     * @return single random 64-bit integer
+     */
+    uint64_t uniform_uint64();
+
+    /**
+     * @brief Independent streams of a seed, each part of a simulation drawing from its own (see \ref substream)
+     */
+    enum Stream {PARAMETERS, TOPOLOGY, NOISE, DELAYS};
+
+    /**
+     * @brief Generator of one stream of the seed of this generator, whatever the numbers already drawn
+     * @param stream the index of the stream, typically a \ref Stream
+     * @return a generator seeded with a hash of the seed and of the stream, so that changing the draws of one stream does not change the others
+     */
+    Random substream(uint64_t stream) const;
+
+    /**
+     * @brief Getter for the seed of the generator
+     * @return the seed given at construction, or the one drawn from the random_device
+     */
+    unsigned long int getSeed() const {return _seed;};
+
+    /**
+     * @brief Getter for the whole state of the generator, to continue its sequence later
+     * @return the seed, the state of the engine and the normal number kept by \ref normal, as text
+     */
+    std::string getState() const;
+
+    /**
+     * @brief Restores a state given by \ref getState
+     * @note Throws a runtime error if the state cannot be read
+     */
+    void setState(const std::string& state);
+
+/*! @name Counter-based streams
+  These functions do not use the generator \ref rng: the number returned is a hash of a (seed, stream, counter) triple.
+  Each stream (for instance one per neuron) is thus independent, and any of its elements (for instance one per step)
+  can be computed directly, in any order and from any thread, with the same result.
+*/
+///@{
+    static uint64_t counter_hash(uint64_t seed, uint64_t stream, uint64_t counter);
+    static double counter_uniform(uint64_t seed, uint64_t stream, uint64_t counter);
+    static double counter_normal(uint64_t seed, uint64_t stream, uint64_t counter);
+///@}
+
+    /**
+     * @brief Fills an array with the normal numbers of consecutive counter-based streams, as given by \ref counter_normal
+     * @param seed the seed of the streams
+     * @param first the first stream
+     * @param counter the element of the streams
+     * @param n the number of streams
+     * @param out the array of size n receiving the numbers
+     * @note The streams 2k and 2k+1 share one Box-Muller transform, so that filling them together only needs one hash and half a logarithm per number
+     */
+    static void counter_normals(uint64_t seed, uint64_t first, uint64_t counter, size_t n, double* out);
+
 private:
     std::mt19937 _rng;
     long int _seed;
+    ///standard normal distribution, kept so that the second number of each of its pairs is not lost
+    std::normal_distribution<> _normal;
 };
 
 template<class T> void Random::uniform_double(T &res, double lower, double upper) {
@@ -91,8 +153,7 @@ template<class T> void Random::uniform_int(T& res, int lower, int upper){
 }
 
 template<class T> void Random::normal(T &res, double mean, double sd) {
-    std::normal_distribution<> norm(mean, sd);
-    for (auto I = res.begin(); I != res.end(); I++) *I = norm(_rng);
+    for (auto I = res.begin(); I != res.end(); I++) *I = _normal(_rng) * sd + mean;
 }
 
 template<class T> void Random::exponential(T& res, const double rate) {
@@ -105,6 +166,44 @@ template<class T> void Random::poisson(T& res, double mean) {
     for (auto I = res.begin(); I != res.end(); I++) *I = pois(_rng);
 }
 
-extern Random* _RNG;
+inline uint64_t Random::counter_hash(uint64_t seed, uint64_t stream, uint64_t counter) {
+    //two rounds of the splitmix64 finalizer, the first one mixing the seed with the stream
+    uint64_t z(seed + 0x9E3779B97F4A7C15ULL * (stream + 1));
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    z ^= (z >> 31) ^ (counter * 0xD1B54A32D192ED03ULL);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    return z ^ (z >> 31);
+}
+
+inline double Random::counter_uniform(uint64_t seed, uint64_t stream, uint64_t counter) {
+    //53 random bits, in (0, 1]
+    return ((counter_hash(seed, stream, counter) >> 11) + 1) * (1.0 / 9007199254740992.0);
+}
+
+/*!
+  @brief A random engine reading one counter-based stream (see \ref Random::counter_hash).
+  It can be given to the distributions of <random>, so that each neuron draws from its own reproducible stream,
+  whatever the thread drawing it.
+*/
+class CounterStream {
+
+public:
+    typedef uint64_t result_type;
+
+    CounterStream(uint64_t seed, uint64_t stream) : _seed(seed), _stream(stream), _counter(0) {};
+
+    static constexpr result_type min() {return 0;};
+    static constexpr result_type max() {return ~result_type(0);};
+
+    /*! @brief Next number of the stream*/
+    result_type operator()() {return Random::counter_hash(_seed, _stream, _counter++);};
+
+private:
+    uint64_t _seed;
+    uint64_t _stream;
+    uint64_t _counter;
+};
 
 #endif //RANDOM_H
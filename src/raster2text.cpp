@@ -0,0 +1,34 @@
+#include <iostream>
+#include <fstream>
+#include <stdexcept>
+#include <memory>
+#include <vector>
+#include <tclap/CmdLine.h>
+#include "spikeWriter.hpp"
+#include "constants.hpp"
+
+int main(int argc, char** argv){
+    try {
+        TCLAP::CmdLine cmd(_CONVERT_TEXT_);
+        TCLAP::MultiArg<std::string> ifiles("i", "input", "Binary raster or events written with -f b or e, or the files of all ranks of a distributed simulation (-M) in their order, merged in one raster", true, "string");
+        cmd.add(ifiles);
+        TCLAP::ValueArg<std::string> ofile("o", "output", "Text raster, read by Rasterplots.R", true, "", "string");
+        cmd.add(ofile);
+        cmd.parse(argc, argv);
+
+        std::vector<std::unique_ptr<std::ifstream>> files;
+        std::vector<std::istream*> ins;
+        for (auto& ifile: ifiles.getValue()) {
+            files.emplace_back(new std::ifstream(ifile, std::ios::in | std::ios::binary));
+            if (not files.back()->is_open()) throw std::runtime_error("Cannot open " + ifile);
+            ins.push_back(files.back().get());
+        }
+        std::ofstream out(ofile.getValue());
+        if (not out.is_open()) throw std::runtime_error("Cannot open " + ofile.getValue());
+        mergeRasters(ins, out);
+    } catch (const std::exception &e) {
+        std::cerr << e.what() << std::endl;
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,85 @@
+#include "replicaBatch.hpp"
+#include <algorithm>
+#include <stdexcept>
+
+ReplicaBatch::ReplicaBatch(const Network& net, size_t replicas)
+    : _net(net), _replicas(replicas), _a(replicas), _b(replicas), _c(replicas), _d(replicas), _input(replicas),
+      _step(net.getStep()), _kernel(integrationKernel())
+{
+    if (replicas == 0 or replicas > MAX_REPLICAS) {
+        throw std::domain_error("The number of replicas must be between 1 and " + std::to_string(MAX_REPLICAS));
+    }
+    if (not net.isSynchronous() or net.getPropagation() != 's') {
+        throw std::domain_error("The replicas can only be made of a network updated by a synchronous scan");
+    }
+    if (net.getPrecision() != 'd') {
+        throw std::domain_error("The replicas read the network in double precision");
+    }
+    for (size_t r(0); r < replicas; r++) {
+        _seeds.push_back(replicaSeed(net.getNoiseSeed(), r));
+    }
+    const NeuronPool& neurons(net.getNeurons());
+    const size_t nb(neurons.size());
+    _v.resize(nb*replicas);
+    _u.resize(nb*replicas);
+    _current.resize(nb*replicas);
+    _firing.assign(nb, 0);
+    _nextFiring.assign(nb, 0);
+    const uint64_t all(replicas == 64 ? ~uint64_t(0) : (uint64_t(1) << replicas) - 1);
+    for (size_t i(0); i < nb; i++) {
+        std::vector<double> variables(neurons.getVariables(i));
+        std::fill(&_v[i*replicas], &_v[(i + 1)*replicas], variables[0]);
+        std::fill(&_u[i*replicas], &_u[(i + 1)*replicas], variables[1]);
+        std::fill(&_current[i*replicas], &_current[(i + 1)*replicas], variables[2]);
+        if ((net.getSpikes()[i >> 6] >> (i & 63)) & 1) {
+            _firing[i] = all;
+        }
+    }
+}
+
+uint64_t ReplicaBatch::replicaSeed(uint64_t seed, size_t replica) {
+    return replica == 0 ? seed : Random::counter_hash(seed, replica, 0);
+}
+
+void ReplicaBatch::update() {
+    const NeuronPool& neurons(_net.getNeurons());
+    const SynapseMatrix& connections(_net.getCon());
+    const double scale(_net.getScale());
+    //the attributes a, b, c, d are the first arrays of the pool
+    const std::array<const double*, NeuronPool::COLUMNS> columns(neurons.columns());
+    const std::vector<int>& order(_net.getOrder());
+    for (size_t i(0); i < neurons.size(); i++) {
+        //same order of summation as the synchronous scan of the network, for each replica
+        std::fill(_input.begin(), _input.end(), 0.0);
+        const int* sources(connections.sources(i));
+        const double* weights(connections.weights(i));
+        for (size_t k(0); k < connections.degree(i); k++) {
+            for (uint64_t bits(_firing[sources[k]]); bits != 0; bits &= bits - 1) {
+                _input[__builtin_ctzll(bits)] += weights[k];
+            }
+        }
+        const double w(neurons.getW(i));
+        //same noise stream as the network: the original index of the neuron
+        const uint64_t stream(order.empty() ? i : order[i]);
+        double* current(&_current[i*_replicas]);
+        for (size_t r(0); r < _replicas; r++) {
+            current[r] = w*Random::counter_normal(_seeds[r], stream, _step) + scale*_input[r];
+        }
+        std::fill(_a.begin(), _a.end(), columns[0][i]);
+        std::fill(_b.begin(), _b.end(), columns[1][i]);
+        std::fill(_c.begin(), _c.end(), columns[2][i]);
+        std::fill(_d.begin(), _d.end(), columns[3][i]);
+        //the replicas of the neuron are consecutive, so they are integrated together, their firing states forming one word
+        _kernel(_replicas, _a.data(), _b.data(), _c.data(), _d.data(), &_v[i*_replicas], &_u[i*_replicas], current, &_nextFiring[i]);
+    }
+    std::swap(_firing, _nextFiring);
+    _step += 1;
+}
+
+std::vector<uint64_t> ReplicaBatch::getSpikes(size_t replica) const {
+    std::vector<uint64_t> spikes((_firing.size() + 63) / 64, 0);
+    for (size_t i(0); i < _firing.size(); i++) {
+        spikes[i >> 6] |= ((_firing[i] >> replica) & 1) << (i & 63);
+    }
+    return spikes;
+}
@@ -0,0 +1,73 @@
+#ifndef REPLICABATCH_HPP
+#define REPLICABATCH_HPP
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+#include "network.hpp"
+#include "kernels.hpp"
+
+
+/**
+ * @brief Several replicas of a network, which differ only by their noise, updated together.
+ *
+ * The replicas share the neurons' parameters and the connections of the network, and each one has its own variables v, u and current,
+ * stored next to the ones of the other replicas for each neuron (replica r of the neuron i at index i*R + r).
+ * The firing state of a neuron in all replicas is one word, whose bit r is set when it fired in replica r.
+ * At each step, the connections are thus walked once for all replicas, and the replicas of each neuron are integrated by one call to
+ * the integration kernel (see \ref IntegrationKernel).
+ *
+ * The update is synchronous, as \ref Network::setSynchronous: the replica 0 continues the network itself with its own noise streams,
+ * and gives the same spikes as its synchronous scan; the replica r draws its noise from the streams of \ref replicaSeed.
+ */
+class ReplicaBatch {
+
+public:
+    ///maximal number of replicas, one per bit of the firing word of a neuron
+    static const size_t MAX_REPLICAS = 64;
+
+    /*! @brief Copies the state of a network in all replicas
+     *  @param net the network, synchronous, whose parameters and connections are read as long as the replicas are updated
+     *  @param replicas the number of replicas, between 1 and \ref MAX_REPLICAS
+     *  @note Throws a domain error if the network is not synchronous, not in double precision, or if the number of replicas is not valid
+     */
+    ReplicaBatch(const Network& net, size_t replicas);
+
+    /*! @brief Seed of the noise streams of a replica
+     *  @param seed the seed of the noise streams of the network
+     *  @param replica the index of the replica
+     *  @return the seed of the network for the replica 0, and a seed derived from it for the others
+     */
+    static uint64_t replicaSeed(uint64_t seed, size_t replica);
+
+    /*! @brief Number of replicas*/
+    size_t replicas() const {return _replicas;};
+
+    /*! @brief Updates all replicas for one step, from their spikes of the previous step*/
+    void update();
+
+    /*! @brief Getter for the spikes of one replica at the last update, as \ref Network::getSpikes*/
+    std::vector<uint64_t> getSpikes(size_t replica) const;
+
+    /*! @brief Getter for the firing state of the neurons in all replicas: the bit r of the word i is set when the neuron i fired in replica r*/
+    const std::vector<uint64_t>& getFiring() const {return _firing;};
+
+    /*! @brief Getter for the membrane potential of a neuron in one replica*/
+    double getV(size_t neuron, size_t replica) const {return _v[neuron*_replicas + replica];};
+
+private:
+    const Network& _net;
+    size_t _replicas;
+    ///seed of the noise streams of each replica
+    std::vector<uint64_t> _seeds;
+    ///variables of the neurons, replica r of the neuron i at index i*R + r
+    std::vector<double> _v, _u, _current;
+    ///replicas in which each neuron fired at the last update, and at the update being done
+    std::vector<uint64_t> _firing, _nextFiring;
+    ///parameters of the neuron being integrated, repeated for each replica, and the synaptic inputs of its replicas
+    std::vector<double> _a, _b, _c, _d, _input;
+    ///number of updates done, used as counter of the noise streams
+    uint64_t _step;
+    IntegrationKernel _kernel;
+};
+
+#endif //REPLICABATCH_HPP
@@ -1,16 +1,39 @@
 #include "simulation.hpp"
 #include "constants.hpp"
+#include "outputQueue.hpp"
+#include "checkpoint.hpp"
+#include "profiler.hpp"
+#include "replicaBatch.hpp"
 #include <tclap/CmdLine.h>
 #include <iostream>
 #include <fstream>
 #include <map>
 #include <string>
 #include <algorithm>
+#include <numeric>
+#include <cmath>
+#include <chrono>
+#include <unistd.h>
+#ifdef USE_MPI
+#include <mpi.h>
+#endif
 
 Simulation::Simulation(const std::string& outfile)
-    : _time(_END_TIME_), _net( new Network(_MOD_, _NB_, _PERC_, _INT_, _LAMB_, _DEL_)), _outfile(outfile), _options(false) {}
+    : _time(_END_TIME_), _net( new Network(_MOD_, _NB_, _PERC_, _INT_, _LAMB_, _DEL_, *_RNG)), _filename(outfile), _options(false),
+      _checkpointEvery(_CHECKPOINT_EVERY_), _checkpointFile(_CHECKPOINT_), _replicas(_REPLICAS_), _seed(_RNG->getSeed())
+{
+    openOutput(_FORMAT_);
+}
+
+Simulation::Simulation(Network* net, const std::string& outfile, char format, double time)
+    : _time(time), _net(net), _filename(outfile), _options(false), _checkpointEvery(0), _checkpointFile(_CHECKPOINT_), _replicas(_REPLICAS_),
+      _seed(_RNG->getSeed())
+{
+    openOutput(format);
+}
 
 Simulation::Simulation(int argc, char** argv)
+    : _net(nullptr)
     {
         try {
             std::string def (", by default : ");
@@ -18,10 +41,26 @@ Simulation::Simulation(int argc, char** argv)
             TCLAP::CmdLine cmd(_PRGRM_TEXT_);
             TCLAP::ValueArg<std::string> ofile("o", "outptut", (_OFILE_TEXT_ + def + _SPIKES_ + _EXTENSION_), false, _SPIKES_, "string");
             cmd.add(ofile);
+            std::vector<char> formats = {'t', 'b', 'a', 'e', 'n'};
+            TCLAP::ValuesConstraint<char> allowedFormats(formats);
+            TCLAP::ValueArg<char> format("f", "format", (_FORMAT_TEXT_ + def + _FORMAT_), false, _FORMAT_, &allowedFormats);
+            cmd.add(format);
 		    std::vector<char> allowed = {'o', 'b', 'c'};
 		    TCLAP::ValuesConstraint<char> allowedVals(allowed);
             TCLAP::ValueArg<char> model("m", "model", (_MODEL_TEXT_ + def + _MOD_), false, _MOD_, &allowedVals);
             cmd.add(model);
+            std::vector<char> propagations = {'s', 'e'};
+            TCLAP::ValuesConstraint<char> allowedProp(propagations);
+            TCLAP::ValueArg<char> propagation("P", "propagation", (_PROP_TEXT_ + def + _PROP_), false, _PROP_, &allowedProp);
+            cmd.add(propagation);
+            std::vector<char> constructions = {'s', 'p'};
+            TCLAP::ValuesConstraint<char> allowedConstructions(constructions);
+            TCLAP::ValueArg<char> construction("C", "construction", (_CONSTRUCTION_TEXT_ + def + _CONSTRUCTION_), false, _CONSTRUCTION_, &allowedConstructions);
+            cmd.add(construction);
+            TCLAP::ValueArg<int> threads("j", "threads", (_THREADS_TEXT_ + def + std::to_string(_THREADS_)), false, _THREADS_, "int");
+            cmd.add(threads);
+            TCLAP::SwitchArg synchronous("S", "synchronous", _SYNC_TEXT_, false);
+            cmd.add(synchronous);
             TCLAP::ValueArg<std::string> type("T", "type",( _TYPE_TEXT_ + ex + _TYPE_), false, "", "string");
             cmd.add(type);
             TCLAP::ValueArg<double> perc("p", "p_E",( _PERCENT_ACTIVE_ + ex + std::to_string(_PERC_)), false, _PERC_, "double");
@@ -36,6 +75,38 @@ Simulation::Simulation(int argc, char** argv)
             cmd.add(time);
             TCLAP::ValueArg<int> number("N", "number", (_NEURON_NUMBER_ + def + std::to_string(_NB_)), false, _NB_, "int");
             cmd.add(number);
+            TCLAP::ValueArg<std::string> load("R", "load-network", _LOAD_TEXT_, false, "", "string");
+            cmd.add(load);
+            TCLAP::ValueArg<std::string> save("W", "save-network", _SAVE_TEXT_, false, "", "string");
+            cmd.add(save);
+            TCLAP::ValueArg<int> every("k", "checkpoint-every", (_CHECKPOINT_EVERY_TEXT_ + def + std::to_string(_CHECKPOINT_EVERY_)), false, _CHECKPOINT_EVERY_, "int");
+            cmd.add(every);
+            TCLAP::ValueArg<std::string> checkpoint("K", "checkpoint", (_CHECKPOINT_TEXT_ + def + _CHECKPOINT_), false, _CHECKPOINT_, "string");
+            cmd.add(checkpoint);
+            TCLAP::SwitchArg resume("r", "resume", _RESUME_TEXT_, false);
+            cmd.add(resume);
+            TCLAP::ValueArg<std::string> sweep("G", "sweep", (_SWEEP_TEXT_ + ex + _SWEEP_), false, "", "string");
+            cmd.add(sweep);
+            TCLAP::ValueArg<int> replicas("B", "replicas", (_REPLICAS_TEXT_ + def + std::to_string(_REPLICAS_)), false, _REPLICAS_, "int");
+            cmd.add(replicas);
+            TCLAP::ValueArg<unsigned long> seed("s", "seed", (_SEED_TEXT_ + def + std::to_string(_SEED_)), false, _SEED_, "int");
+            cmd.add(seed);
+            TCLAP::ValueArg<int> delays("D", "delays", (_DELAY_TEXT_ + def + std::to_string(_DELAY_)), false, _DELAY_, "int");
+            cmd.add(delays);
+            std::vector<char> precisions = {'d', 'f', 'h'};
+            TCLAP::ValuesConstraint<char> allowedPrecisions(precisions);
+            TCLAP::ValueArg<char> precision("Q", "precision", (_PRECISION_TEXT_ + def + _PRECISION_), false, _PRECISION_, &allowedPrecisions);
+            cmd.add(precision);
+            TCLAP::SwitchArg report("E", "precision-report", _PRECISION_REPORT_TEXT_, false);
+            cmd.add(report);
+            TCLAP::SwitchArg reorder("O", "reorder", _REORDER_TEXT_, false);
+            cmd.add(reorder);
+            TCLAP::ValueArg<std::string> statistics("A", "statistics", (_STATISTICS_TEXT_ + ex + _SUMMARY_), false, "", "string");
+            cmd.add(statistics);
+            TCLAP::SwitchArg mpi("M", "mpi", _MPI_TEXT_, false);
+            cmd.add(mpi);
+            TCLAP::SwitchArg profile("X", "profile", _PROFILE_TEXT_, false);
+            cmd.add(profile);
             TCLAP::SwitchArg option("c", "options", (_OPTION_TEXT_ + def + _SAMPLES_ + _EXTENSION_ + " and " + _PARAMETERS_ + _EXTENSION_), false);
             cmd.add(option);
             cmd.parse(argc, argv);
@@ -44,15 +115,68 @@ Simulation::Simulation(int argc, char** argv)
             if(number.getValue() <= 0) throw std::domain_error("The number of neuron must be positive or greater than 0");
             if(lambda.getValue() < 0) throw std::domain_error("The mean connection between neurons must be positive and not exceed the number of neuron");
             if(inten.getValue() <= 0) throw  std::domain_error("The mean intensity of a connection must be positive and greater than 0");
+            if(threads.getValue() <= 0) throw std::domain_error("The number of threads must be positive and greater than 0");
+            if(replicas.getValue() < 1 or replicas.getValue() > int(ReplicaBatch::MAX_REPLICAS)) {
+                throw std::domain_error("The number of replicas must be between 1 and " + std::to_string(ReplicaBatch::MAX_REPLICAS));
+            }
+            if(replicas.getValue() > 1 and (option.getValue() or every.getValue() > 0 or resume.getValue() or sweep.isSet() or propagation.getValue() == 'e'
+                                            or delays.getValue() > 0)) {
+                throw std::domain_error("The replicas (-B) are updated by a synchronous scan, without the options -c, -k, -r, -G, -P e and -D");
+            }
+            if(delays.getValue() < 0 or delays.getValue() > UINT16_MAX) {
+                throw std::domain_error("The largest delay must be between 0 and " + std::to_string(UINT16_MAX) + " steps");
+            }
+            if(delays.getValue() > 0 and propagation.isSet() and propagation.getValue() != 'e') {
+                throw std::domain_error("The delays (-D) are delivered by the event-driven propagation (-P e)");
+            }
+            if(precision.getValue() != 'd' and (sweep.isSet() or replicas.getValue() > 1)) {
+                throw std::domain_error("The reduced precisions (-Q) are read by the update of a single network, without the options -G and -B");
+            }
+            if(report.getValue() and (precision.getValue() == 'd' or every.getValue() > 0 or resume.getValue())) {
+                throw std::domain_error("The precision report (-E) compares a reduced precision (-Q f or h) with double from the first step, without the options -k and -r");
+            }
+            if(reorder.getValue() and (sweep.isSet() or replicas.getValue() > 1 or resume.getValue())) {
+                throw std::domain_error("The reordering (-O) is done once the network is built, without the options -G, -B and -r");
+            }
+            if(format.getValue() == 'n' and not statistics.isSet()) {
+                throw std::domain_error("The format n writes no spikes, it is only used with the statistics (-A)");
+            }
+            if(statistics.isSet() and (every.getValue() > 0 or resume.getValue() or sweep.isSet() or replicas.getValue() > 1)) {
+                throw std::domain_error("The statistics (-A) are computed from the first step, without the options -k, -r, -G and -B");
+            }
+            if(mpi.getValue() and (option.getValue() or every.getValue() > 0 or resume.getValue() or sweep.isSet() or replicas.getValue() > 1
+                                   or load.isSet() or save.isSet() or propagation.getValue() == 'e' or delays.getValue() > 0
+                                   or precision.getValue() != 'd' or reorder.getValue() or statistics.isSet()
+                                   or (construction.isSet() and construction.getValue() != 'p'))) {
+                throw std::domain_error("A distributed simulation (-M) is a synchronous scan of the parallel construction, without the options -c, -k, -r, -G, -B, -R, -W, -P e, -D, -Q, -O, -A and -C s");
+            }
+            if(mpi.getValue() and format.isSet() and format.getValue() != 'b' and format.getValue() != 'e') {
+                throw std::domain_error("The ranks of a distributed simulation (-M) write binary rasters or events (-f b or e), merged by raster2text");
+            }
+#ifndef USE_MPI
+            if(mpi.getValue()) throw std::domain_error("The distributed simulation (-M) needs the program compiled with MPI (cmake -Dmpi=ON)");
+#endif
+            if(every.getValue() < 0) throw std::domain_error("The number of steps between two checkpoints must be positive, or 0 for no checkpoint");
+            if(threads.getValue() > 1 and not synchronous.getValue() and precision.getValue() == 'd' and propagation.getValue() != 'e' and delays.getValue() == 0 and construction.getValue() != 'p'
+               and not resume.getValue() and not sweep.isSet() and not mpi.getValue()) {
+                throw std::domain_error("Several threads can only be used with a synchronous update (-S or -P e), a parallel construction (-C p) or a sweep (-G)");
+            }
             
             if ((number.getValue()*lambda.getValue()) > 1e8) throw std::domain_error("The computer probably won't have the memory necessary to deal with a network as large as this one. "
                                                                                       "Please reduce the number of neurons or the mean connectivity (lambda)");
             _time = time.getValue();
             _options = option.getValue();
+            _checkpointEvery = every.getValue();
+            _checkpointFile = checkpoint.getValue();
+            _replicas = replicas.getValue();
+            _statistics = statistics.getValue();
             std::string filename(ofile.getValue());
             _filename = ofile.getValue();
-            if (filename.find(_EXTENSION_, (filename.size() - 4)) == std::string::npos) {
-                _filename += _EXTENSION_;
+            //the ranks of a distributed simulation write binary events unless another binary format is chosen
+            const char output(mpi.getValue() and not format.isSet() ? 'e' : format.getValue());
+            std::string extension((output == 'b' or output == 'e') ? _EXTENSION_BIN_ : _EXTENSION_);
+            if (filename.size() < extension.size() or filename.find(extension, (filename.size() - extension.size())) == std::string::npos) {
+                _filename += extension;
             }
             if (argc == 1) {
                 std::cerr << "Warning : For information on the usage of this program type ./neuron_network -h in the command line" << std::endl;
@@ -65,26 +189,138 @@ Simulation::Simulation(int argc, char** argv)
             if(delta.getValue() < 0 or delta.getValue() > 1) {
                 throw std::domain_error("The value of delta should be between 0 and 1");
             }  
-            if(type.isSet() and perc.isSet()) {
-                throw std::domain_error("Only the percentage of excitating neurons (p) or the proportion of different types (T) should be given");
+            if (profile.getValue()) {
+#ifdef PROFILING
+                Profiler::instance().enable(true);
+#else
+                std::cerr << "Warning: the profiler was not compiled (cmake -Dprofiling=ON), no report will be written" << std::endl;
+#endif
             }
-            else if (perc.isSet() or (not perc.isSet() and not type.isSet())) {
-                _net = new Network(model.getValue(), number.getValue(), perc.getValue(), inten.getValue(),
-                                   std::min(lambda.getValue(), tmp), delta.getValue());
-                if (_options) {
-                    initializeSample(perc.getValue());
+            if (seed.getValue() != 0) {
+                *_RNG = Random(seed.getValue());
+            }
+#ifdef USE_MPI
+            if (mpi.getValue()) {
+                //all ranks build the network of the seed of the first one
+                uint64_t first(_RNG->getSeed());
+                MPI_Bcast(&first, 1, MPI_UINT64_T, 0, MPI_COMM_WORLD);
+                *_RNG = Random(first);
+            }
+#endif
+            _seed = _RNG->getSeed();
+            const Random root(*_RNG);
+            if (sweep.isSet()) {
+                if (type.isSet() or _options or _checkpointEvery > 0 or resume.getValue() or load.isSet() or save.isSet() or delays.getValue() > 0) {
+                    throw std::domain_error("A sweep (-G) can only be combined with -N, -m, -p, -l, -L, -d, -t, -P, -C, -j, -f and -o");
                 }
-            } 
-            else if(type.isSet()) {
-                double FS(0), IB(0), RZ(0), LTS(0), TC(0), CH(0);
+                const Sweep::Point defaults = {inten.getValue(), std::min(lambda.getValue(), tmp), perc.getValue(), delta.getValue()};
+                _sweep.reset(new Sweep(sweep.getValue(), defaults, model.getValue(), number.getValue(), propagation.getValue(),
+                                       construction.getValue(), _time, format.getValue(), _filename, threads.getValue()));
+                return;
+            }
+            double FS(0), IB(0), RZ(0), LTS(0), TC(0), CH(0);
+            if (type.isSet() and not load.isSet() and not resume.getValue()) {
                 readLine(type.getValue(), FS, IB, RZ, LTS, TC, CH);
-                _net = new Network(model.getValue(), number.getValue(), FS, IB, RZ, LTS, TC, CH,inten.getValue(),
-                                    std::min(lambda.getValue(), tmp), delta.getValue());
-                if (_options) {
-                    initializeSample(FS, LTS, IB, RZ, TC, CH);
+            }
+            //builds the network from the stream of the parameters, again for the reference of the precision report
+            auto build = [&] () -> Network* {
+                *_RNG = root.substream(Random::PARAMETERS);
+                Network* net;
+                if (load.isSet()) {
+                    net = new Network(load.getValue(), *_RNG);
+                }
+                else if (type.isSet()) {
+                    net = new Network(model.getValue(), number.getValue(), FS, IB, RZ, LTS, TC, CH,inten.getValue(),
+                                      std::min(lambda.getValue(), tmp), delta.getValue(), *_RNG, construction.getValue(), threads.getValue());
+                }
+                else {
+                    net = new Network(model.getValue(), number.getValue(), perc.getValue(), inten.getValue(),
+                                      std::min(lambda.getValue(), tmp), delta.getValue(), *_RNG, construction.getValue(), threads.getValue());
+                }
+                if (reorder.getValue()) {
+                    net->reorder();
+                }
+                return net;
+            };
+            {
+                PROFILE_SCOPE(BUILD);
+                if (resume.getValue()) {
+                    *_RNG = root.substream(Random::PARAMETERS);
+                    _net = new Network(Checkpoint::networkFile(_checkpointFile), *_RNG);
+                }
+                else if(type.isSet() and perc.isSet() and not load.isSet()) {
+                    throw std::domain_error("Only the percentage of excitating neurons (p) or the proportion of different types (T) should be given");
+                }
+                else if (mpi.getValue()) {
+#ifdef USE_MPI
+                    //the seed of the noise streams is the one drawn by the synchronous update of the whole network
+                    const uint64_t noiseSeed(root.substream(Random::NOISE).uniform_uint64());
+                    int rank(0), ranks(1);
+                    MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+                    MPI_Comm_size(MPI_COMM_WORLD, &ranks);
+                    *_RNG = root.substream(Random::PARAMETERS);
+                    const std::array<int, NEURON_TYPES> counts(type.isSet() ? DistributedNetwork::typeCounts(number.getValue(), FS, IB, RZ, LTS, TC, CH)
+                                                                           : DistributedNetwork::typeCounts(number.getValue(), perc.getValue()));
+                    _distributed.reset(new DistributedNetwork(rank, ranks, model.getValue(), counts, inten.getValue(), std::min(lambda.getValue(), tmp),
+                                                              delta.getValue(), noiseSeed, *_RNG, threads.getValue()));
+#endif
+                }
+                else {
+                    _net = build();
+                    if (report.getValue()) {
+                        _reference.reset(build());
+                    }
+                    if (_options and load.isSet()) {
+                        initializeSample();
+                    }
+                    else if (_options and type.isSet()) {
+                        initializeSample(FS, LTS, IB, RZ, TC, CH);
+                    }
+                    else if (_options) {
+                        initializeSample(perc.getValue());
+                    }
+                }
+            }
+            if (_distributed) {
+                _format = output;
+                return;
+            }
+            if (save.isSet()) {
+                _net->save(save.getValue());
+            }
+            if (resume.getValue()) {
+                resumeFrom(_checkpointFile, threads.getValue());
+            }
+            else {
+                //the noise, and the seed of the noise streams of the synchronous update, are drawn from their own stream,
+                //the reference of the precision report being updated like the network but with double weights
+                auto setup = [&] (Network& net, char weights) {
+                    *_RNG = root.substream(Random::NOISE);
+                    net.setThreads(threads.getValue());
+                    net.setPropagation(propagation.getValue());
+                    if (synchronous.getValue() or _replicas > 1 or precision.getValue() != 'd') {
+                        net.setSynchronous(true);
+                    }
+                    if (delays.getValue() > 0) {
+                        net.setDelays(delays.getValue(), root.substream(Random::DELAYS).uniform_uint64());
+                    }
+                    net.setPrecision(weights);
+                };
+                if (_reference) {
+                    setup(*_reference, 'd');
+                }
+                setup(*_net, precision.getValue());
+                if (_checkpointEvery > 0) {
+                    _net->save(Checkpoint::networkFile(_checkpointFile));
+                }
+                if (_replicas > 1) {
+                    //each replica is written in its own file by runReplicas
+                    _format = output;
+                }
+                else {
+                    openOutput(output);
                 }
             }
-            _outfile.open(_filename);
             
         } catch(const std::exception& e) {
             std::cerr << e.what() << std::endl;
@@ -96,54 +332,333 @@ Simulation::~Simulation() {
     delete _net;
 }
 
-int Simulation::run() {
-    time_t ex_time = time(NULL);
-    struct tm * ptm;
-    double running_time(0);
-    int index = 1;
+double Simulation::run() {
+    if (_sweep) {
+        return _sweep->run();
+    }
+    if (_replicas > 1) {
+        return runReplicas();
+    }
+    if (_distributed) {
+        return runDistributed();
+    }
+    const auto start(std::chrono::steady_clock::now());
+    double running_time(_resumed ? _resumed->time : 0);
+    int index = _resumed ? _resumed->step + 1 : 1;
+    std::ofstream samples;
     if (_options) {
-        std::ofstream samples;
         std::string file = _SAMPLES_;
         samples.open(file + _EXTENSION_, std::ios::app);
-        while (running_time < _time) {
-            running_time += 2*_DELTA_T_;
-            _net->update();
-            print(index);
-            samples << index;
-            samplePrint(samples);
-            index += 1;
+    }
+    //number of connections leaving each neuron, to count the synaptic events delivered by the spikes
+    std::vector<uint32_t> outDegree;
+    uint64_t written(0);
+    if (PROFILE_ENABLED()) {
+        const SynapseMatrix& con(_net->getCon());
+        outDegree.assign(con.size(), 0);
+        for (size_t k(0); k < con.nonZeros(); ++k) {
+            outDegree[con.sources()[k]] += 1;
+        }
+        written = (_outfile.is_open() ? uint64_t(_outfile.tellp()) : 0) + (samples.is_open() ? uint64_t(samples.tellp()) : 0);
+    }
+    //the noise of the reference of the precision report is drawn again from the same state
+    const std::string noise(_reference ? _RNG->getState() : "");
+    std::unique_ptr<SpikeStatistics> statistics;
+    if (not _statistics.empty() or _reference) {
+        statistics.reset(new SpikeStatistics(_net->getNeurons(), 2*_DELTA_T_));
+    }
+    //the steps are formatted and written by another thread while the next ones are computed
+    OutputQueue queue(_QUEUE_, [this, &samples, &statistics] (const OutputFrame& frame) {
+        {
+            PROFILE_SCOPE(PRINT);
+            _writer->write(frame.step, frame.spikes);
+            if (statistics) {
+                statistics->add(frame.step, frame.spikes);
+            }
+        }
+        if (_options) {
+            PROFILE_SCOPE(SAMPLE);
+            samples << frame.step;
+            writeSamples(samples, frame.samples);
+        }
+        if (frame.checkpoint) {
+            PROFILE_SCOPE(CHECKPOINT);
+            //the checkpoint is completed with the size of the files once this step is written
+            _writer->flush();
+            _outfile.flush();
+            samples.flush();
+            frame.checkpoint->outputSize = _outfile.is_open() ? uint64_t(_outfile.tellp()) : 0;
+            frame.checkpoint->samplesSize = samples.is_open() ? uint64_t(samples.tellp()) : 0;
+            frame.checkpoint->writerState = _writer->getState();
+            frame.checkpoint->write(_checkpointFile);
+        }
+    });
+    while (running_time < _time) {
+        running_time += 2*_DELTA_T_;
+        _net->update();
+        if (PROFILE_ENABLED()) {
+            countSpikes(outDegree);
         }
+        OutputFrame& frame(acquire(queue));
+        frame.step = index;
+        _net->getOriginalSpikes(frame.spikes);
+        if (_options) {
+            sample(frame.samples);
+        }
+        frame.checkpoint.reset();
+        if (_checkpointEvery > 0 and index % _checkpointEvery == 0) {
+            //only the state is copied here, the checkpoint is written by the writer thread
+            PROFILE_SCOPE(CHECKPOINT);
+            frame.checkpoint.reset(new Checkpoint());
+            frame.checkpoint->step = index;
+            frame.checkpoint->time = running_time;
+            frame.checkpoint->output = _filename;
+            frame.checkpoint->format = _format;
+            frame.checkpoint->options = _options;
+            frame.checkpoint->random = _RNG->getState();
+            frame.checkpoint->network = _net->getState();
+            frame.checkpoint->seed = _seed;
+        }
+        queue.publish();
+        index += 1;
+    }
+    queue.close();
+    _writer->flush();
+    if (PROFILE_ENABLED()) {
+        _outfile.flush();
+        samples.flush();
+        written = (_outfile.is_open() ? uint64_t(_outfile.tellp()) : 0) + (samples.is_open() ? uint64_t(samples.tellp()) : 0) - written;
+        Profiler::instance().count(Profiler::BYTES, written);
+    }
+    _outfile.close();
+    if (_options) {
         samples.close();
         paramPrint();
-    } 
-    else {
-        while (running_time < _time) {
-            running_time += 2*_DELTA_T_;
-            _net->update();
-            print(index);
-            index += 1;
+    }
+    if (_reference) {
+        _RNG->setState(noise);
+        precisionReport(*statistics);
+    }
+    if (not _statistics.empty()) {
+        std::ofstream summary(_statistics);
+        std::ofstream population(SpikeStatistics::populationFile(_statistics));
+        if (not summary.is_open() or not population.is_open()) {
+            throw std::runtime_error("The statistics " + _statistics + " cannot be written");
         }
+        statistics->write(summary, _seed);
+        statistics->writePopulation(population, _seed);
     }
-    _outfile.close();
-    ex_time = time(NULL);
-    ptm = gmtime(&ex_time);
-    return ptm->tm_sec;
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+void Simulation::precisionReport(const SpikeStatistics& statistics) {
+    //the reference run is not part of the profile of the simulation
+    const bool profiled(Profiler::instance().enabled());
+    Profiler::instance().enable(false);
+    SpikeStatistics reference(_reference->getNeurons(), 2*_DELTA_T_);
+    std::vector<uint64_t> spikes;
+    while (reference.steps() < statistics.steps()) {
+        _reference->update();
+        _reference->getOriginalSpikes(spikes);
+        reference.add(reference.steps() + 1, spikes);
+    }
+    Profiler::instance().enable(profiled);
+    std::cerr << "Precision report (" << _net->getPrecision() << " weights against double)\n"
+              << "largest error of the weights: " << _net->getWeightError() << "\n";
+    statistics.compare(std::cerr, reference);
+    std::cerr << std::flush;
+}
+
+OutputFrame& Simulation::acquire(OutputQueue& queue) {
+    PROFILE_SCOPE(WAIT);
+    return queue.acquire();
 }
 
-void Simulation::print(int index) {
+void Simulation::countSpikes(const std::vector<uint32_t>& outDegree) const {
+    uint64_t spikes(0), events(0);
+    const std::vector<uint64_t>& fired(_net->getSpikes());
+    for (size_t word(0); word < fired.size(); ++word) {
+        for (uint64_t bits(fired[word]); bits != 0; bits &= bits - 1) {
+            spikes += 1;
+            events += outDegree[64*word + __builtin_ctzll(bits)];
+        }
+    }
+    Profiler::instance().count(Profiler::STEPS, 1);
+    Profiler::instance().count(Profiler::SPIKES, spikes);
+    Profiler::instance().count(Profiler::EVENTS, events);
+}
+
+double Simulation::runReplicas() {
+    const auto start(std::chrono::steady_clock::now());
+    ReplicaBatch batch(*_net, _replicas);
+    const bool binary(_format == 'b' or _format == 'e');
+    std::vector<std::unique_ptr<std::ofstream>> files;
+    std::vector<std::unique_ptr<SpikeWriter>> writers;
+    for (size_t r(0); r < _replicas; r++) {
+        const std::string file(numberedFile(_filename, r, _replicas));
+        files.emplace_back(new std::ofstream(file, binary ? std::ios::out | std::ios::binary : std::ios::out));
+        if (not files.back()->is_open()) {
+            throw std::runtime_error("The output file " + file + " cannot be written");
+        }
+        writers.push_back(makeWriter(*files.back(), _format, _net->getNeurons()));
+    }
+    double running_time(0);
+    for (int index(1); running_time < _time; index++) {
+        running_time += 2*_DELTA_T_;
+        {
+            PROFILE_SCOPE(UPDATE);
+            batch.update();
+        }
+        PROFILE_COUNT(STEPS, 1);
+        PROFILE_COUNT(SPIKES, std::accumulate(batch.getFiring().begin(), batch.getFiring().end(), uint64_t(0),
+                                              [](uint64_t sum, uint64_t bits) {return sum + __builtin_popcountll(bits);}));
+        PROFILE_SCOPE(PRINT);
+        for (size_t r(0); r < _replicas; r++) {
+            writers[r]->write(index, batch.getSpikes(r));
+        }
+    }
+    for (size_t r(0); r < _replicas; r++) {
+        writers[r]->flush();
+        if (PROFILE_ENABLED()) {
+            files[r]->flush();
+            Profiler::instance().count(Profiler::BYTES, files[r]->tellp());
+        }
+        files[r]->close();
+    }
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+double Simulation::runDistributed() {
+    const auto start(std::chrono::steady_clock::now());
+    const std::string file(numberedFile(_filename, _distributed->getRank(), _distributed->getRanks()));
+    std::ofstream out(file, std::ios::out | std::ios::binary);
+    if (not out.is_open()) {
+        throw std::runtime_error("The output file " + file + " cannot be written");
+    }
+    std::unique_ptr<SpikeWriter> writer(makeWriter(out, _format, _distributed->getNeurons()));
+    double running_time(0);
+    for (int index(1); running_time < _time; index++) {
+        running_time += 2*_DELTA_T_;
+        {
+            PROFILE_SCOPE(UPDATE);
+            _distributed->update();
+        }
+#ifdef USE_MPI
+        {
+            PROFILE_SCOPE(WAIT);
+            _distributed->exchange(MPI_COMM_WORLD);
+        }
+#endif
+        PROFILE_COUNT(STEPS, 1);
+        PROFILE_SCOPE(PRINT);
+        writer->write(index, _distributed->getLocalSpikes());
+    }
+    writer->flush();
+    if (PROFILE_ENABLED()) {
+        out.flush();
+        Profiler::instance().count(Profiler::BYTES, out.tellp());
+    }
+    out.close();
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+int Simulation::steps() const {
+    return std::ceil(_time / (2*_DELTA_T_));
+}
+
+void Simulation::openOutput(char format, bool resume) {
+    const bool binary(format == 'b' or format == 'e');
+    std::ios::openmode mode(binary ? std::ios::out | std::ios::binary : std::ios::out);
+    //a resumed file is continued and not truncated
+    if (format != 'n') {
+        _outfile.open(_filename, resume ? mode | std::ios::in : mode);
+    }
+    _format = format;
     std::ostream *outstr = &std::cout;
     if (_outfile.is_open()){
         outstr = &_outfile;
     } 
-    std::vector<bool> matrix = _net->getCurrentstatus();
-    *outstr << index << " "; 
-    for(auto neuron : matrix) {
-        *outstr << neuron << " ";
+    _writer = makeWriter(*outstr, format, _net->getNeurons(), resume);
+    if (resume) {
+        outstr->seekp(0, std::ios::end);
     }
-    *outstr << "\n";
+}
+
+std::unique_ptr<SpikeWriter> Simulation::makeWriter(std::ostream& out, char format, const NeuronPool& neurons, bool resume) const {
+    std::unique_ptr<SpikeWriter> writer;
+    if (format == 'b' or format == 'e') {
+        RasterHeader header(RasterHeader::layout(neurons));
+        header.steps = steps();
+        header.dt = 2*_DELTA_T_;
+        header.seed = _seed;
+        if (resume) {
+            //the number of steps changes when a finished simulation is extended
+            header.format = format;
+            header.write(out);
+            out.seekp(0, std::ios::end);
+        }
+        if (format == 'e') {
+            writer.reset(new EventBinaryWriter(out, header, resume));
+        }
+        else {
+            writer.reset(new BinaryRasterWriter(out, header, resume));
+        }
+    }
+    else if (format == 'n') {
+        writer.reset(new DiscardWriter(out, neurons.size()));
+    }
+    else {
+        if (not resume) {
+            writeSeed(out, _seed);
+        }
+        if (format == 'a') {
+            writer.reset(new EventTextWriter(out, neurons.size()));
+        }
+        else {
+            writer.reset(new TextRasterWriter(out, neurons.size()));
+        }
+    }
+    return writer;
+}
+
+std::string Simulation::numberedFile(const std::string& file, size_t number, size_t count) {
+    //the numbers have the same width, so that the files are listed in their order
+    const std::string last(std::to_string(count - 1));
+    std::string digits(std::to_string(number));
+    if (digits.size() < last.size()) {
+        digits.insert(0, last.size() - digits.size(), '0');
+    }
+    const size_t dot(file.rfind('.'));
+    if (dot == std::string::npos) {
+        return file + "_" + digits;
+    }
+    return file.substr(0, dot) + "_" + digits + file.substr(dot);
+}
+
+void Simulation::resumeFrom(const std::string& checkpoint, int threads) {
+    _resumed.reset(new Checkpoint(Checkpoint::read(checkpoint)));
+    _RNG->setState(_resumed->random);
+    _seed = _resumed->seed;
+    _net->setState(_resumed->network);
+    if (threads > 1 and not _net->isSynchronous()) {
+        throw std::domain_error("Several threads can only be used to resume a synchronous update");
+    }
+    _net->setThreads(threads);
+    _filename = _resumed->output;
+    _options = _resumed->options;
+    //the steps written after the checkpoint are written again
+    if (truncate(_filename.c_str(), _resumed->outputSize) != 0) {
+        throw std::runtime_error("The output file " + _filename + " cannot be resumed");
+    }
+    if (_options and truncate((std::string(_SAMPLES_) + _EXTENSION_).c_str(), _resumed->samplesSize) != 0) {
+        throw std::runtime_error("The samples file cannot be resumed");
+    }
+    openOutput(_resumed->format, true);
+    _writer->setState(_resumed->writerState);
 }
 
 void Simulation::paramPrint() {
+    PROFILE_SCOPE(PARAMETERS);
     std::ostream *outstr = &std::cout;
     std::ofstream param;
     std::string file = _PARAMETERS_;
@@ -152,9 +667,10 @@ void Simulation::paramPrint() {
         outstr = &param;
     }
     std::vector<Neuron*> netw(_net->getNet());
-    std::vector<std::map<Neuron*, double>> con(_net->getCon());
+    const SynapseMatrix& con(_net->getCon());
     std::vector<double> attributs;
     int inhib(0);
+    writeSeed(*outstr, _seed);
     *outstr << "\t a\t b\t c\t d\t Inhibitory\t degree\t valence\n";
     for(size_t i(0); i<netw.size(); ++i) {
         attributs = netw[i]->getAttributs();
@@ -168,26 +684,26 @@ void Simulation::paramPrint() {
         else {
             inhib = 0;
         }
-        *outstr << inhib << "\t" << con[i].size() << "\t" << _net->getValence(i) << "\n";
+        *outstr << inhib << "\t" << con.degree(i) << "\t" << _net->getValence(i) << "\n";
     }
     param.close();
 }
 
-void Simulation::samplePrint(std::ofstream& file) {
-    std::ostream *outstr = &std::cout; 
-    if (file.is_open()) {
-        outstr = &file;
-    }
-    std::vector<double> attributs;
+void Simulation::sample(std::vector<double>& values) const {
+    values.clear();
     for (size_t k(0); k < _net->getNeuronsOutput().size(); k++) {
         if (_net->getNeuronsOutput()[k] != nullptr) {
-            attributs = (_net->getNeuronsOutput()[k])->getVariables();
-            for (size_t j(0); j < attributs.size(); ++j) {
-                *outstr << "\t" << attributs[j];
-            }
+            std::vector<double> attributs((_net->getNeuronsOutput()[k])->getVariables());
+            values.insert(values.end(), attributs.begin(), attributs.end());
         }
     }
-    *outstr << "\n";
+}
+
+void Simulation::writeSamples(std::ostream& out, const std::vector<double>& values) {
+    for (size_t j(0); j < values.size(); ++j) {
+        out << "\t" << values[j];
+    }
+    out << "\n";
 }
 
 void Simulation::readLine(std::string& line,  double& fs, double& ib, double& rz, double& lts, double& tc, double& ch) 
@@ -211,11 +727,29 @@ void Simulation::readLine(std::string& line,  double& fs, double& ib, double& rz
     }
 }
 
+void Simulation::initializeSample()
+{
+    std::ofstream samples;
+    std::string file = _SAMPLES_;
+    samples.open(file + _EXTENSION_);
+    const std::vector<std::string> types = {"FS", "LTS", "IB", "RZ", "TC", "CH", "RS"};
+    std::string headers;
+    for (size_t k(0); k < types.size(); ++k) {
+        if (_net->getNeuronsOutput()[k] != nullptr) {
+            headers += (headers.empty() ? "" : "\t ") + types[k] + ".v\t " + types[k] + ".u\t " + types[k] + ".I";
+        }
+    }
+    writeSeed(samples, _seed);
+    samples << headers << "\n";
+    samples.close();
+}
+
 void Simulation::initializeSample(double p_E)
 {
     std::ofstream samples;
     std::string file = _SAMPLES_;
     samples.open(file + _EXTENSION_); 
+    writeSeed(samples, _seed);
     if (p_E == 0) {
         samples << "FS.v\t FS.u\t FS.I\n";
     } else if (p_E == 1) {
@@ -254,6 +788,7 @@ void Simulation::initializeSample(double p_FS, double p_LTS, double p_IB, double
         headers += "\t RS.v\t RS.u\t RS.I";
     }
     headers += "\n";
+    writeSeed(samples, _seed);
     samples << headers;
     samples.close();
 }
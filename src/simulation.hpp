@@ -2,8 +2,19 @@
 #define SIMULATION_HPP
 
 #include "network.hpp"
+#include "distributedNetwork.hpp"
+#include "spikeWriter.hpp"
+#include "checkpoint.hpp"
+#include "outputQueue.hpp"
+#include "sweep.hpp"
+#include "spikeStatistics.hpp"
 #include <fstream>
-#include <time.h>
+#include <memory>
+
+/*! @brief Generator of the program, whose state is replaced by the stream of each stage of the simulation (see \ref Random::substream)
+    and given to the networks it builds. The library does not use it: main defines it.
+*/
+extern Random* _RNG;
 
 /**
  * @brief The \ref Simulation class is the main class of this program.
@@ -27,6 +38,20 @@ public :
         @param _model the model chosen for the connections (a char)
         @param _delta a tunable parameter for neuron noise (a double)
         @param _type the repartition of different types of neurons (a string)
+        @param propagation the way synaptic currents are computed, by scan or by events (a char)
+        @param synchronous can be turned on for all neurons to read the spikes of the previous step
+        @param construction the construction of the connections, sequential or parallel (a char)
+        @param threads the number of threads building the network in parallel or updating it in synchronous mode (an int)
+        @param format the format of the output of the spikes, text or binary raster, text or binary events (a char)
+        @param load the snapshot from which the network is loaded instead of being built (a string)
+        @param save the file in which a snapshot of the network is written (a string)
+        @param every the number of steps between two checkpoints, 0 for none (an int)
+        @param checkpoint the name of the checkpoint file, the network being saved next to it (a string)
+        @param resume can be turned on to resume the simulation from the checkpoint, until the new end time
+        @param sweep the grid of parameters over which the simulation is run several times instead, in one process (see \ref Sweep)
+        @param replicas the number of replicas of the network, differing only by their noise, updated together and written in numbered files (see \ref ReplicaBatch)
+        @param mpi can be turned on for each process started by mpirun to simulate its part of the network (see \ref DistributedNetwork)
+        @param profile can be turned on to time the phases of the simulation and write a summary at the end (see \ref Profiler)
         @param _option can be turned on to generate two supplementary files with data about the neurons of the network
     */
     Simulation(int argc, char** argv);
@@ -36,6 +61,14 @@ public :
      */
     Simulation(const std::string& outfile);
 
+    /*! @brief Creates a Simulation of a network already built, for instance one run of a \ref Sweep
+     *  @param net the network, deleted with the simulation
+     *  @param outfile the file for the output
+     *  @param format the format of this file (see \ref openOutput)
+     *  @param time the time until the end of the simulation, in ms
+     */
+    Simulation(Network* net, const std::string& outfile, char format, double time);
+
     /*! @brief Destroys the _network attribute
   */
     ~Simulation();
@@ -43,22 +76,26 @@ public :
     /*!
       @brief Runs the simulation and counts the execution time
              Uses attribute _dt as one step of time for the simulation.
-      @return the execution time
+             The outputs of each step are written by a writer thread while the next steps are computed,
+             as well as the checkpoints, whose state is copied by the simulation loop.
+             For a sweep, all its runs are done instead.
+      @return the execution time, in seconds
     */
-    int run();
+    double run();
 
-    /*!
-      @brief Writes into the ofstream the status of each neuron in the network for every step of time.*/
-    void print(int index);
+    /*! @brief Name of one of several numbered files
+     *  @param file the name of the file, the number being added before its extension
+     *  @param number the number of the file
+     *  @param count the number of files, all numbers having as many digits as the last one
+     */
+    static std::string numberedFile(const std::string& file, size_t number, size_t count);
+
+    /*! @brief Number of steps of the simulation*/
+    int steps() const;
 
     /*! @brief Writes into a new file the state of the parameters for each neuron.*/ 
     void paramPrint();
 
-    /*! @brief Writes into a new file the _v, _u and _current of one neuron of each type present in the simulation for each step of time.
-        @param file the ofstream used for print the variables 
-     */ 
-    void samplePrint(std::ofstream& file);
-
     /*! @brief Reads the line passed as argument and extracts each proportion for the given types of neuron
         @param line from which we can extract informations
         @param fs,ib,rz,lts,tc,ch are the proportions of neurons initialized to zero and are set if they match the line given in argument
@@ -66,6 +103,10 @@ public :
      */ 
     void readLine(std::string& line,  double& fs, double& ib, double& rz, double& lts, double& tc, double& ch);
 
+    /*! @brief Initialisation of the sample file, with the types of neurons present in the network
+     */
+    void initializeSample();
+
     /*! @brief Initialisation of the sample file
      *  @param p_E proportion of excitatory Neurons
      */
@@ -82,6 +123,59 @@ public :
     void initializeSample(double p_FS, double p_LTS, double p_IB, double p_RZ, double p_TC, double p_CH);
 
 private :
+    /*! @brief Opens the output file and creates the writer of the spikes
+        @param format 't' for a text raster, 'b' for a binary raster, 'a' for text events or 'e' for binary events
+        @param resume true to continue the file of a resumed simulation
+     */
+    void openOutput(char format, bool resume = false);
+
+    /*! @brief Creates the writer of the spikes in a stream
+        @param out the stream, opened in binary mode for the binary formats
+        @param format the format of the output (see \ref openOutput)
+        @param neurons the neurons whose spikes are written
+        @param resume true to continue a binary file, whose header is written again
+     */
+    std::unique_ptr<SpikeWriter> makeWriter(std::ostream& out, char format, const NeuronPool& neurons, bool resume = false) const;
+
+    /*! @brief Runs the replicas of the network together, each one writing its spikes in its own numbered file
+        @return the execution time, in seconds
+     */
+    double runReplicas();
+
+    /*! @brief Runs the part of the network of this rank, exchanging the spikes with the other ranks at each step,
+        the spikes of its neurons being written in its own numbered file
+        @return the execution time, in seconds
+     */
+    double runDistributed();
+
+    /*! @brief Restores the state of a checkpoint in the network loaded from its snapshot, and reopens the output files where it was taken
+        @param checkpoint the name of the checkpoint file
+        @param threads the number of threads updating the network
+     */
+    void resumeFrom(const std::string& checkpoint, int threads);
+
+    /*! @brief Runs the reference network with double weights for as many steps as the simulation, from the same noise,
+        and writes on the standard error the error of the reduced weights and the comparison of the rates
+        @param statistics the statistics of the spikes of the simulation
+     */
+    void precisionReport(const SpikeStatistics& statistics);
+
+    /*! @brief Gives the next frame of the queue, the time spent waiting for the writer thread being profiled*/
+    static OutputFrame& acquire(OutputQueue& queue);
+
+    /*! @brief Counts a step, its spikes and the synaptic events they deliver in the \ref Profiler
+        @param outDegree the number of connections leaving each neuron
+     */
+    void countSpikes(const std::vector<uint32_t>& outDegree) const;
+
+    /*! @brief Gathers the _v, _u and _current of the sampled neurons
+        @param values the vector in which they are written, reused between steps
+     */
+    void sample(std::vector<double>& values) const;
+
+    /*! @brief Writes a line of sampled variables, each one after a tab*/
+    static void writeSamples(std::ostream& out, const std::vector<double>& values);
+
     ///number of step of the \ref simulation
     double _time;
     ///associated network
@@ -90,8 +184,30 @@ private :
     std::ofstream _outfile;
     ///name of this file
     std::string _filename;
+    ///writer of the spikes in the output file, in the chosen format
+    std::unique_ptr<SpikeWriter> _writer;
+    ///format of the output file
+    char _format;
     ///saves the choice of the user for supplementary files
     bool _options;
+    ///number of steps between two checkpoints, 0 for none
+    int _checkpointEvery;
+    ///name of the checkpoint file
+    std::string _checkpointFile;
+    ///checkpoint from which the simulation is resumed, if any
+    std::unique_ptr<Checkpoint> _resumed;
+    ///number of replicas of the network simulated together, 1 for a single simulation
+    size_t _replicas;
+    ///runs done instead of this simulation, if a sweep is asked
+    std::unique_ptr<Sweep> _sweep;
+    ///seed of the random generator, written at the beginning of the outputs
+    uint64_t _seed;
+    ///name of the summary file of the statistics of the spikes (see \ref SpikeStatistics), empty for none
+    std::string _statistics;
+    ///same network with double weights, run after the simulation for the precision report, if asked
+    std::unique_ptr<Network> _reference;
+    ///part of the network simulated by this rank instead of the network, for a distributed simulation
+    std::unique_ptr<DistributedNetwork> _distributed;
 };
 
 #endif //SIMULATION_HPP
\ No newline at end of file
@@ -0,0 +1,150 @@
+#include "spikeStatistics.hpp"
+#include "spikeWriter.hpp"
+#include <cmath>
+#include <algorithm>
+#include <stdexcept>
+
+SpikeStatistics::SpikeStatistics(const NeuronPool& neurons, double dt)
+    : _dt(dt), _typeSizes(NEURON_TYPES, 0), _spikes(neurons.size(), 0), _last(neurons.size(), 0),
+      _isiMean(neurons.size(), 0.0), _isiM2(neurons.size(), 0.0)
+{
+    _types.reserve(neurons.size());
+    for (size_t i(0); i < neurons.size(); i++) {
+        _types.push_back(neurons.typeOf(i));
+        _typeSizes[size_t(_types.back())] += 1;
+    }
+}
+
+void SpikeStatistics::add(int step, const std::vector<uint64_t>& spikes) {
+    uint32_t fired(0);
+    for (size_t word(0); word < spikes.size(); ++word) {
+        for (uint64_t bits(spikes[word]); bits != 0; bits &= bits - 1) {
+            const size_t i(64*word + __builtin_ctzll(bits));
+            if (_spikes[i] > 0) {
+                //Welford's update with the new interval, the n-th one being the interval before the (n+1)-th spike
+                const double isi(step - _last[i]);
+                const double delta(isi - _isiMean[i]);
+                _isiMean[i] += delta / _spikes[i];
+                _isiM2[i] += delta * (isi - _isiMean[i]);
+            }
+            _spikes[i] += 1;
+            _last[i] = step;
+            fired += 1;
+        }
+    }
+    _population.push_back(fired);
+}
+
+size_t SpikeStatistics::steps() const {
+    return _population.size();
+}
+
+uint32_t SpikeStatistics::getSpikes(size_t neuron) const {
+    return _spikes[neuron];
+}
+
+double SpikeStatistics::getRate(size_t neuron) const {
+    return _population.empty() ? 0 : 1000.0 * _spikes[neuron] / (_population.size() * _dt);
+}
+
+double SpikeStatistics::getIsiMean(size_t neuron) const {
+    return _spikes[neuron] < 2 ? 0 : _isiMean[neuron] * _dt;
+}
+
+double SpikeStatistics::getIsiCv(size_t neuron) const {
+    if (_spikes[neuron] < 2) {
+        return 0;
+    }
+    return std::sqrt(_isiM2[neuron] / (_spikes[neuron] - 1)) / _isiMean[neuron];
+}
+
+double SpikeStatistics::getTypeRate(NeuronType type) const {
+    const size_t size(_typeSizes[size_t(type)]);
+    if (size == 0 or _population.empty()) {
+        return 0;
+    }
+    uint64_t spikes(0);
+    for (size_t i(0); i < _types.size(); i++) {
+        if (_types[i] == type) {
+            spikes += _spikes[i];
+        }
+    }
+    return 1000.0 * spikes / (size * _population.size() * _dt);
+}
+
+const std::vector<uint32_t>& SpikeStatistics::getPopulation() const {
+    return _population;
+}
+
+void SpikeStatistics::write(std::ostream& out, uint64_t seed) const {
+    writeSeed(out, seed);
+    const double duration(_population.size() * _dt);
+    out << "# neurons " << _types.size() << ", steps " << _population.size() << ", duration " << duration << " ms\n";
+    for (size_t type(0); type < NEURON_TYPES; type++) {
+        if (_typeSizes[type] > 0) {
+            out << "# " << TYPE_TRAITS[type].name << ": " << _typeSizes[type] << " neurons, "
+                << getTypeRate(NeuronType(type)) << " Hz\n";
+        }
+    }
+    //mean and standard deviation of the population rate over the steps
+    double mean(0), sd(0);
+    uint32_t most(0);
+    for (auto fired: _population) {
+        mean += fired;
+        sd += double(fired) * fired;
+        most = std::max(most, fired);
+    }
+    if (not _population.empty() and not _types.empty()) {
+        const double rate(1000 / (_types.size() * _dt));
+        mean /= _population.size();
+        sd = std::sqrt(std::max(0.0, sd / _population.size() - mean * mean));
+        out << "# population: " << mean * rate << " Hz, sd " << sd * rate << " Hz, max " << most * rate << " Hz\n";
+    }
+    out << "neuron\t type\t spikes\t rate\t isi_mean\t isi_cv\n";
+    for (size_t i(0); i < _types.size(); i++) {
+        out << i << "\t " << TYPE_TRAITS[size_t(_types[i])].name << "\t " << _spikes[i] << "\t " << getRate(i) << "\t "
+            << getIsiMean(i) << "\t " << getIsiCv(i) << "\n";
+    }
+}
+
+void SpikeStatistics::writePopulation(std::ostream& out, uint64_t seed) const {
+    writeSeed(out, seed);
+    const double rate(_types.empty() ? 0 : 1000 / (_types.size() * _dt));
+    out << "step\t rate\n";
+    for (size_t step(0); step < _population.size(); step++) {
+        out << step + 1 << "\t " << _population[step] * rate << "\n";
+    }
+}
+
+void SpikeStatistics::compare(std::ostream& out, const SpikeStatistics& reference) const {
+    if (reference._types != _types) {
+        throw std::domain_error("The statistics of simulations of different neurons cannot be compared");
+    }
+    auto line = [&out](const std::string& name, double expected, double rate) {
+        out << name << "\t " << expected << "\t " << rate << "\t " << (expected > 0 ? 100 * (rate - expected) / expected : 0) << "\n";
+    };
+    out << "\t reference (Hz)\t rate (Hz)\t difference (%)\n";
+    double expected(0), rate(0), difference(0);
+    for (size_t type(0); type < NEURON_TYPES; type++) {
+        if (_typeSizes[type] > 0) {
+            line(TYPE_TRAITS[type].name, reference.getTypeRate(NeuronType(type)), getTypeRate(NeuronType(type)));
+        }
+    }
+    for (size_t i(0); i < _types.size(); i++) {
+        expected += reference.getRate(i);
+        rate += getRate(i);
+        difference += std::abs(getRate(i) - reference.getRate(i));
+    }
+    if (not _types.empty()) {
+        line("all", expected / _types.size(), rate / _types.size());
+        out << "mean absolute difference of the rates of the neurons: " << difference / _types.size() << " Hz\n";
+    }
+}
+
+std::string SpikeStatistics::populationFile(const std::string& summary) {
+    const size_t dot(summary.rfind('.'));
+    if (dot == std::string::npos) {
+        return summary + "_population";
+    }
+    return summary.substr(0, dot) + "_population" + summary.substr(dot);
+}
@@ -0,0 +1,98 @@
+#ifndef SPIKESTATISTICS_HPP
+#define SPIKESTATISTICS_HPP
+#include <vector>
+#include <string>
+#include <ostream>
+#include <cstdint>
+#include "neuronPool.hpp"
+#include "neuronTypes.hpp"
+
+
+/**
+ * @brief Statistics of the spikes of a simulation, computed step by step instead of reading the whole raster afterwards.
+ *
+ * For each neuron, the number of its spikes and the mean and the variance of its interspike intervals (ISI),
+ * updated at each spike with Welford's algorithm. For each step, the number of neurons which fired (the population rate).
+ * The memory does not depend on the number of steps, but for the population rate (4 bytes per step).
+ */
+class SpikeStatistics {
+
+public:
+    /*! @brief Prepares the statistics of the neurons of a pool
+     *  @param neurons the neurons, whose types are used for the rates of each type
+     *  @param dt the duration of a step, in ms
+     */
+    SpikeStatistics(const NeuronPool& neurons, double dt);
+
+    /*! @brief Adds the spikes of one step
+     *  @param step the index of the step, starting at 1, the steps being added in order
+     *  @param spikes the bitmask of the neurons which fired (see \ref Network::getSpikes)
+     */
+    void add(int step, const std::vector<uint64_t>& spikes);
+
+    /*! @brief Number of steps added*/
+    size_t steps() const;
+
+    /*! @brief Number of spikes of a neuron*/
+    uint32_t getSpikes(size_t neuron) const;
+
+    /*! @brief Mean firing rate of a neuron, in Hz*/
+    double getRate(size_t neuron) const;
+
+    /*! @brief Mean interspike interval of a neuron, in ms, 0 if it fired less than twice*/
+    double getIsiMean(size_t neuron) const;
+
+    /*! @brief Coefficient of variation (standard deviation over mean) of the interspike intervals of a neuron, 0 if it fired less than twice*/
+    double getIsiCv(size_t neuron) const;
+
+    /*! @brief Mean firing rate of the neurons of a type, in Hz, 0 if there is none*/
+    double getTypeRate(NeuronType type) const;
+
+    /*! @brief Number of neurons which fired at each step*/
+    const std::vector<uint32_t>& getPopulation() const;
+
+    /*! @brief Writes the summary: the rates of each type and of the population as comment lines, then one line per neuron
+     *  (its index, type, number of spikes, rate in Hz, and the mean in ms and coefficient of variation of its interspike intervals)
+     *  @param out the stream in which the summary is written
+     *  @param seed the seed of the simulation, written first (see \ref writeSeed)
+     */
+    void write(std::ostream& out, uint64_t seed) const;
+
+    /*! @brief Writes the population rate, one line per step with its index and the rate of the network in Hz
+     *  @param out the stream in which the rates are written
+     *  @param seed the seed of the simulation, written first (see \ref writeSeed)
+     */
+    void writePopulation(std::ostream& out, uint64_t seed) const;
+
+    /*! @brief Compares the rates with the ones of a reference simulation of the same neurons, for instance in another precision:
+     *  one line for each type and for the population with the reference rate, this rate and their relative difference,
+     *  then the mean absolute difference of the rates of the neurons
+     *  @param out the stream in which the comparison is written
+     *  @param reference the statistics of the reference simulation
+     *  @note Throws a domain error if the simulations do not have the same neurons
+     */
+    void compare(std::ostream& out, const SpikeStatistics& reference) const;
+
+    /*! @brief Name of the file of the population rate written next to a summary file: its name with "_population" before the extension*/
+    static std::string populationFile(const std::string& summary);
+
+private:
+    ///duration of a step, in ms
+    double _dt;
+    ///type of each neuron
+    std::vector<NeuronType> _types;
+    ///number of neurons of each type
+    std::vector<size_t> _typeSizes;
+    ///number of spikes of each neuron
+    std::vector<uint32_t> _spikes;
+    ///step of the last spike of each neuron
+    std::vector<int> _last;
+    ///mean interspike interval of each neuron, in steps
+    std::vector<double> _isiMean;
+    ///sum of the squared deviations of the interspike intervals of each neuron from their mean (Welford)
+    std::vector<double> _isiM2;
+    ///number of neurons which fired at each step
+    std::vector<uint32_t> _population;
+};
+
+#endif //SPIKESTATISTICS_HPP
@@ -0,0 +1,344 @@
+#include "spikeWriter.hpp"
+#include <cstring>
+#include <stdexcept>
+#include <memory>
+
+namespace {
+
+const char MAGIC[8] = {'I', 'Z', 'R', 'A', 'S', 'T', 'E', 'R'};
+const char EVENTS_MAGIC[8] = {'I', 'Z', 'E', 'V', 'E', 'N', 'T', 'S'};
+//size of the buffers of the event writers before they are written
+const size_t BUFFER_SIZE(1 << 16);
+const uint32_t VERSION(1);
+
+void writeUint(std::ostream& out, uint64_t value, int bytes) {
+    char buffer[8];
+    for (int i(0); i < bytes; ++i) {
+        buffer[i] = char((value >> (8*i)) & 0xFF);
+    }
+    out.write(buffer, bytes);
+}
+
+uint64_t readUint(std::istream& in, int bytes) {
+    unsigned char buffer[8];
+    if (not in.read(reinterpret_cast<char*>(buffer), bytes)) {
+        throw std::runtime_error("The binary raster is truncated");
+    }
+    uint64_t value(0);
+    for (int i(0); i < bytes; ++i) {
+        value |= uint64_t(buffer[i]) << (8*i);
+    }
+    return value;
+}
+
+uint64_t readVarint(std::istream& in) {
+    uint64_t value(0);
+    for (int shift(0); shift < 64; shift += 7) {
+        int byte(in.get());
+        if (byte == EOF) {
+            throw std::runtime_error("The binary events are truncated");
+        }
+        value |= uint64_t(byte & 0x7F) << shift;
+        if (not (byte & 0x80)) return value;
+    }
+    throw std::runtime_error("The binary events are corrupted");
+}
+
+}
+
+RasterHeader RasterHeader::layout(const NeuronPool& neurons) {
+    RasterHeader header = {'b', neurons.size(), 0, 0, 0, {}};
+    for (size_t i(0); i < neurons.size(); ++i) {
+        if (header.types.empty() or header.types.back().first != neurons.getType(i)) {
+            header.types.push_back(std::make_pair(neurons.getType(i), 0));
+        }
+        header.types.back().second += 1;
+    }
+    return header;
+}
+
+void RasterHeader::write(std::ostream& out) const {
+    out.write(format == 'e' ? EVENTS_MAGIC : MAGIC, sizeof(MAGIC));
+    writeUint(out, VERSION, 4);
+    writeUint(out, types.size(), 4);
+    writeUint(out, neurons, 8);
+    writeUint(out, steps, 8);
+    uint64_t bits;
+    std::memcpy(&bits, &dt, sizeof(bits));
+    writeUint(out, bits, 8);
+    writeUint(out, seed, 8);
+    for (auto& type: types) {
+        char name[8] = {0};
+        type.first.copy(name, sizeof(name));
+        out.write(name, sizeof(name));
+        writeUint(out, type.second, 8);
+    }
+}
+
+RasterHeader RasterHeader::read(std::istream& in) {
+    char magic[8];
+    RasterHeader header;
+    if (not in.read(magic, sizeof(magic))) {
+        throw std::runtime_error("This file is not a binary raster");
+    }
+    else if (std::memcmp(magic, MAGIC, sizeof(MAGIC)) == 0) {
+        header.format = 'b';
+    }
+    else if (std::memcmp(magic, EVENTS_MAGIC, sizeof(EVENTS_MAGIC)) == 0) {
+        header.format = 'e';
+    }
+    else {
+        throw std::runtime_error("This file is not a binary raster");
+    }
+    if (readUint(in, 4) != VERSION) {
+        throw std::runtime_error("This version of binary raster is not supported");
+    }
+    size_t runs(readUint(in, 4));
+    header.neurons = readUint(in, 8);
+    header.steps = readUint(in, 8);
+    uint64_t bits(readUint(in, 8));
+    std::memcpy(&header.dt, &bits, sizeof(bits));
+    header.seed = readUint(in, 8);
+    for (size_t i(0); i < runs; ++i) {
+        char name[9] = {0};
+        if (not in.read(name, 8)) {
+            throw std::runtime_error("The binary raster is truncated");
+        }
+        header.types.push_back(std::make_pair(std::string(name), readUint(in, 8)));
+    }
+    return header;
+}
+
+SpikeWriter::SpikeWriter(std::ostream& out, size_t neurons)
+    : _out(out), _neurons(neurons)
+{}
+
+SpikeWriter::~SpikeWriter()
+{}
+
+void SpikeWriter::flush()
+{}
+
+uint64_t SpikeWriter::getState() const {
+    return 0;
+}
+
+void SpikeWriter::setState(uint64_t)
+{}
+
+TextRasterWriter::TextRasterWriter(std::ostream& out, size_t neurons)
+    : SpikeWriter(out, neurons)
+{}
+
+void TextRasterWriter::write(int step, const std::vector<uint64_t>& spikes) {
+    _line = std::to_string(step);
+    _line += ' ';
+    const size_t start(_line.size());
+    _line.resize(start + 2*_neurons + 1, ' ');
+    for (size_t i(0); i < _neurons; ++i) {
+        _line[start + 2*i] = ((spikes[i >> 6] >> (i & 63)) & 1) ? '1' : '0';
+    }
+    _line.back() = '\n';
+    _out.write(_line.data(), _line.size());
+}
+
+BinaryRasterWriter::BinaryRasterWriter(std::ostream& out, const RasterHeader& header, bool resume)
+    : SpikeWriter(out, header.neurons)
+{
+    if (not resume) {
+        header.write(_out);
+    }
+}
+
+void BinaryRasterWriter::write(int, const std::vector<uint64_t>& spikes) {
+    const size_t bytes((_neurons + 7) / 8);
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+    //the bytes of the words already are in the order of the neurons
+    _out.write(reinterpret_cast<const char*>(spikes.data()), bytes);
+#else
+    for (size_t i(0); i < bytes; ++i) {
+        _out.put(char((spikes[i / 8] >> (8*(i % 8))) & 0xFF));
+    }
+#endif
+}
+
+EventTextWriter::EventTextWriter(std::ostream& out, size_t neurons)
+    : SpikeWriter(out, neurons)
+{}
+
+EventTextWriter::~EventTextWriter() {
+    flush();
+}
+
+void EventTextWriter::write(int step, const std::vector<uint64_t>& spikes) {
+    const std::string prefix(std::to_string(step) + ' ');
+    for (size_t word(0); word < spikes.size(); ++word) {
+        for (uint64_t bits(spikes[word]); bits != 0; bits &= bits - 1) {
+            _buffer += prefix;
+            _buffer += std::to_string(64*word + __builtin_ctzll(bits));
+            _buffer += '\n';
+        }
+    }
+    if (_buffer.size() >= BUFFER_SIZE) {
+        flush();
+    }
+}
+
+void EventTextWriter::flush() {
+    _out.write(_buffer.data(), _buffer.size());
+    _buffer.clear();
+}
+
+EventBinaryWriter::EventBinaryWriter(std::ostream& out, RasterHeader header, bool resume)
+    : SpikeWriter(out, header.neurons), _last(0)
+{
+    header.format = 'e';
+    if (not resume) {
+        header.write(_out);
+    }
+    _buffer.reserve(BUFFER_SIZE + 1024);
+}
+
+EventBinaryWriter::~EventBinaryWriter() {
+    flush();
+}
+
+void EventBinaryWriter::write(int step, const std::vector<uint64_t>& spikes) {
+    _fired.clear();
+    for (size_t word(0); word < spikes.size(); ++word) {
+        for (uint64_t bits(spikes[word]); bits != 0; bits &= bits - 1) {
+            _fired.push_back(64*word + __builtin_ctzll(bits));
+        }
+    }
+    if (_fired.empty()) return;
+    put(step - _last);
+    put(_fired.size());
+    uint64_t previous(0);
+    for (auto neuron: _fired) {
+        put(neuron - previous);
+        previous = neuron;
+    }
+    _last = step;
+    if (_buffer.size() >= BUFFER_SIZE) {
+        flush();
+    }
+}
+
+void EventBinaryWriter::flush() {
+    _out.write(_buffer.data(), _buffer.size());
+    _buffer.clear();
+}
+
+uint64_t EventBinaryWriter::getState() const {
+    return _last;
+}
+
+void EventBinaryWriter::setState(uint64_t state) {
+    _last = state;
+}
+
+void EventBinaryWriter::put(uint64_t value) {
+    while (value >= 0x80) {
+        _buffer.push_back(char((value & 0x7F) | 0x80));
+        value >>= 7;
+    }
+    _buffer.push_back(char(value));
+}
+
+DiscardWriter::DiscardWriter(std::ostream& out, size_t neurons)
+    : SpikeWriter(out, neurons)
+{}
+
+void DiscardWriter::write(int, const std::vector<uint64_t>&)
+{}
+
+void writeSeed(std::ostream& out, uint64_t seed) {
+    out << "# seed " << seed << '\n';
+}
+
+RasterReader::RasterReader(std::istream& in)
+    : _in(in), _header(RasterHeader::read(in)), _step(0), _event(0), _row((_header.neurons + 7) / 8)
+{}
+
+bool RasterReader::next(std::vector<uint64_t>& spikes) {
+    spikes.assign((_header.neurons + 63) / 64, 0);
+    if (_header.format == 'e') {
+        //the steps between two steps with spikes are empty, and so are the last steps after the last spike
+        if (_event == 0 and _in.peek() != EOF) {
+            //a step with spikes comes after the previous one and within the steps of the header
+            const uint64_t delta(readVarint(_in));
+            if (delta == 0 or delta > _header.steps - _step) {
+                throw std::runtime_error("The binary events are corrupted");
+            }
+            _event = _step + delta;
+        }
+        if (_event == 0 and _step >= _header.steps) {
+            return false;
+        }
+        _step += 1;
+        if (_step == _event) {
+            uint64_t count(readVarint(_in));
+            uint64_t neuron(0);
+            for (uint64_t k(0); k < count; ++k) {
+                neuron += readVarint(_in);
+                if (neuron >= _header.neurons) {
+                    throw std::runtime_error("The binary events are corrupted");
+                }
+                spikes[neuron >> 6] |= uint64_t(1) << (neuron & 63);
+            }
+            _event = 0;
+        }
+        return true;
+    }
+    if (_step >= _header.steps or not _in.read(reinterpret_cast<char*>(_row.data()), _row.size())) {
+        return false;
+    }
+    for (size_t i(0); i < _row.size(); ++i) {
+        spikes[i / 8] |= uint64_t(_row[i]) << (8*(i % 8));
+    }
+    _step += 1;
+    return true;
+}
+
+uint64_t convertRaster(std::istream& in, std::ostream& out) {
+    return mergeRasters({&in}, out);
+}
+
+uint64_t mergeRasters(const std::vector<std::istream*>& ins, std::ostream& out) {
+    std::vector<std::unique_ptr<RasterReader>> readers;
+    uint64_t neurons(0);
+    for (auto in: ins) {
+        readers.emplace_back(new RasterReader(*in));
+        const RasterHeader& header(readers.back()->header());
+        if (header.seed != readers[0]->header().seed or header.steps != readers[0]->header().steps) {
+            throw std::runtime_error("The rasters merged are not written by the same simulation");
+        }
+        neurons += header.neurons;
+    }
+    writeSeed(out, readers.empty() ? 0 : readers[0]->header().seed);
+    TextRasterWriter writer(out, neurons);
+    std::vector<uint64_t> spikes((neurons + 63) / 64), part;
+    uint64_t step(0);
+    while (not readers.empty()) {
+        std::fill(spikes.begin(), spikes.end(), 0);
+        uint64_t offset(0);
+        bool read(true);
+        for (auto& reader: readers) {
+            read = reader->next(part) and read;
+            for (size_t word(0); word < part.size(); ++word) {
+                for (uint64_t bits(part[word]); bits != 0; bits &= bits - 1) {
+                    const uint64_t neuron(offset + 64*word + __builtin_ctzll(bits));
+                    spikes[neuron >> 6] |= uint64_t(1) << (neuron & 63);
+                }
+            }
+            offset += reader->header().neurons;
+        }
+        if (not read) {
+            break;
+        }
+        step += 1;
+        writer.write(step, spikes);
+    }
+    writer.flush();
+    return step;
+}
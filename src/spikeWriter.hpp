@@ -0,0 +1,253 @@
+#ifndef SPIKEWRITER_HPP
+#define SPIKEWRITER_HPP
+#include <vector>
+#include <string>
+#include <utility>
+#include <ostream>
+#include <istream>
+#include <cstdint>
+#include "neuronPool.hpp"
+
+
+/**
+ * @brief Description of a simulation written at the beginning of the binary output files.
+ *
+ * On disk, all numbers are little-endian: the magic string ("IZRASTER" for a dense raster, "IZEVENTS" for events), the version (uint32),
+ * the number of type runs (uint32), the number of neurons, of steps (uint64), the time step in ms (double),
+ * the seed (uint64), then for each run of consecutive neurons of the same type, its name (8 chars) and its length (uint64).
+ */
+struct RasterHeader {
+    ///format of the file, 'b' for a dense binary raster and 'e' for binary events
+    char format;
+    ///number of neurons of the network
+    uint64_t neurons;
+    ///number of steps of the simulation
+    uint64_t steps;
+    ///duration of a step, in ms
+    double dt;
+    ///seed of the random generator of the simulation
+    uint64_t seed;
+    ///layout of the neurons: the type and the number of neurons of each run of neurons of the same type
+    std::vector<std::pair<std::string, uint64_t>> types;
+
+    /*! @brief Builds the layout of the neurons of a pool, the other fields being left to zero*/
+    static RasterHeader layout(const NeuronPool& neurons);
+
+    /*! @brief Writes the header in a binary stream*/
+    void write(std::ostream& out) const;
+
+    /*! @brief Reads a header from a binary stream
+     *  @note Throws a runtime error if the stream does not start with a valid header
+     */
+    static RasterHeader read(std::istream& in);
+};
+
+
+/**
+ * @brief Base class of the outputs of the spikes of a simulation.
+ *
+ * A writer receives, at each step, the bitmask of the neurons which fired
+ * (bit i%64 of word i/64 for the neuron i), as given by \ref Network::getSpikes.
+ */
+class SpikeWriter {
+
+public:
+    /*! @brief Constructs a writer for a given number of neurons
+     *  @param out the stream in which the spikes are written
+     *  @param neurons the number of neurons
+     */
+    SpikeWriter(std::ostream& out, size_t neurons);
+
+    virtual ~SpikeWriter();
+
+    /*! @brief Writes the spikes of one step
+     *  @param step the index of the step, starting at 1
+     *  @param spikes the bitmask of the neurons which fired
+     */
+    virtual void write(int step, const std::vector<uint64_t>& spikes) = 0;
+
+    /*! @brief Writes the spikes kept in a buffer, if any*/
+    virtual void flush();
+
+    /*! @brief Getter for the state needed to continue the file later, once flushed (see \ref setState)
+     *  @return 0 for the writers which do not depend on the steps already written
+     */
+    virtual uint64_t getState() const;
+
+    /*! @brief Restores the state given by \ref getState, to continue a file*/
+    virtual void setState(uint64_t state);
+
+protected:
+    ///stream in which the spikes are written
+    std::ostream& _out;
+    ///number of neurons
+    size_t _neurons;
+};
+
+
+/**
+ * @brief Dense text raster, as read by Rasterplots.R: one line per step, the index of the step followed by a 0 or a 1 for each neuron.
+ */
+class TextRasterWriter : public SpikeWriter {
+
+public:
+    TextRasterWriter(std::ostream& out, size_t neurons);
+
+    virtual void write(int step, const std::vector<uint64_t>& spikes) override;
+
+private:
+    ///line being formatted, kept between steps to avoid reallocating it
+    std::string _line;
+};
+
+
+/**
+ * @brief Dense binary raster: a \ref RasterHeader, then for each step one bit per neuron,
+ * neuron i being the bit i%8 of the byte i/8 of the step (N/8 bytes per step, rounded up).
+ */
+class BinaryRasterWriter : public SpikeWriter {
+
+public:
+    /*! @brief Writes the header and prepares the writing of the steps
+     *  @param out a stream opened in binary mode
+     *  @param header the description of the simulation
+     *  @param resume true to continue a file whose header is already written
+     */
+    BinaryRasterWriter(std::ostream& out, const RasterHeader& header, bool resume = false);
+
+    virtual void write(int step, const std::vector<uint64_t>& spikes) override;
+};
+
+
+/**
+ * @brief Sparse text output of the spikes (address events): one line "step neuron" for each spike.
+ */
+class EventTextWriter : public SpikeWriter {
+
+public:
+    EventTextWriter(std::ostream& out, size_t neurons);
+
+    virtual ~EventTextWriter();
+
+    virtual void write(int step, const std::vector<uint64_t>& spikes) override;
+
+    virtual void flush() override;
+
+private:
+    ///lines waiting to be written
+    std::string _buffer;
+};
+
+
+/**
+ * @brief Sparse binary output of the spikes (address events), delta-encoded.
+ *
+ * After a \ref RasterHeader, each step with at least one spike is written as unsigned LEB128 varints:
+ * the number of steps since the previous written step (or since step 0), the number of spikes,
+ * the index of the first neuron which fired, then the difference between the index of each next neuron and the previous one.
+ */
+class EventBinaryWriter : public SpikeWriter {
+
+public:
+    /*! @brief Writes the header and prepares the writing of the steps
+     *  @param out a stream opened in binary mode
+     *  @param header the description of the simulation, its format being set to 'e'
+     *  @param resume true to continue a file whose header is already written
+     */
+    EventBinaryWriter(std::ostream& out, RasterHeader header, bool resume = false);
+
+    virtual ~EventBinaryWriter();
+
+    virtual void write(int step, const std::vector<uint64_t>& spikes) override;
+
+    virtual void flush() override;
+
+    /*! @brief The last step written, from which the next one is encoded*/
+    virtual uint64_t getState() const override;
+
+    virtual void setState(uint64_t state) override;
+
+private:
+    /*! @brief Appends an unsigned LEB128 varint to the buffer*/
+    void put(uint64_t value);
+
+    ///encoded steps waiting to be written
+    std::vector<char> _buffer;
+    ///indices of the neurons which fired at the step being encoded
+    std::vector<uint64_t> _fired;
+    ///last step written
+    int _last;
+};
+
+
+/**
+ * @brief Writer discarding the spikes, when only their statistics are kept (see \ref SpikeStatistics).
+ */
+class DiscardWriter : public SpikeWriter {
+
+public:
+    DiscardWriter(std::ostream& out, size_t neurons);
+
+    virtual void write(int step, const std::vector<uint64_t>& spikes) override;
+};
+
+
+/**
+ * @brief Writes the seed of a simulation at the beginning of a text output, as a comment line "# seed ..." skipped by Rasterplots.R
+ */
+void writeSeed(std::ostream& out, uint64_t seed);
+
+
+/**
+ * @brief Reads back, step by step, the spikes of a binary raster or of binary events.
+ */
+class RasterReader {
+
+public:
+    /*! @brief Reads the header of the file
+     *  @param in the binary raster or events, opened in binary mode
+     *  @note Throws a runtime error if the stream does not start with a valid header
+     */
+    explicit RasterReader(std::istream& in);
+
+    /*! @brief Getter for the header of the file*/
+    const RasterHeader& header() const {return _header;};
+
+    /*! @brief Reads the spikes of the next step
+     *  @param spikes the bitmask in which they are written, with one bit for each neuron of the file
+     *  @return false once all steps have been read
+     *  @note Throws a runtime error if the events are corrupted
+     */
+    bool next(std::vector<uint64_t>& spikes);
+
+private:
+    std::istream& _in;
+    RasterHeader _header;
+    ///last step read
+    uint64_t _step;
+    ///next step with spikes in binary events, 0 until it is read
+    uint64_t _event;
+    ///bits of one step of a dense raster
+    std::vector<unsigned char> _row;
+};
+
+
+/**
+ * @brief Converts a binary raster or binary events back to the text raster read by Rasterplots.R, after the seed of its header (see \ref writeSeed)
+ * @param in the binary raster
+ * @param out the stream in which the text raster is written
+ * @return the number of steps converted
+ */
+uint64_t convertRaster(std::istream& in, std::ostream& out);
+
+/**
+ * @brief Merges the binary rasters or events written by the ranks of a distributed simulation (see \ref DistributedNetwork)
+ * into the text raster of the whole network, the neurons of each file following the ones of the previous file
+ * @param ins the files of the ranks, in the order of the ranks
+ * @param out the stream in which the text raster is written
+ * @return the number of steps merged
+ * @note Throws a runtime error if the files do not have the same seed and number of steps
+ */
+uint64_t mergeRasters(const std::vector<std::istream*>& ins, std::ostream& out);
+
+#endif //SPIKEWRITER_HPP
@@ -0,0 +1,152 @@
+#include "sweep.hpp"
+#include "simulation.hpp"
+#include "threadPool.hpp"
+#include "profiler.hpp"
+#include <fstream>
+#include <sstream>
+#include <chrono>
+#include <algorithm>
+#include <stdexcept>
+
+Sweep::Sweep(const std::string& grid, const Point& defaults, char model, int nb, char propagation, char construction,
+             double time, char format, const std::string& output, size_t threads)
+    : _model(model), _nb(nb), _propagation(propagation), _construction(construction), _time(time), _format(format),
+      _output(output), _threads(threads), _seed(_RNG->getSeed())
+{
+    std::map<char, std::vector<double>> values(parseGrid(grid));
+    auto axis = [&values](char key, double value) {
+        return values.count(key) ? values[key] : std::vector<double>(1, value);
+    };
+    const std::vector<double> intensities(axis('L', defaults.intensity)), lambdas(axis('l', defaults.lambda));
+    const std::vector<double> proportions(axis('p', defaults.p_E)), deltas(axis('d', defaults.delta));
+    for (auto intensity: intensities) {
+        if (intensity <= 0) throw std::domain_error("The mean intensity of a connection must be positive and greater than 0");
+    }
+    for (auto lambda: lambdas) {
+        if (lambda < 0 or lambda > nb - 1) throw std::domain_error("The mean connection between neurons must be positive and less than the number of neurons");
+    }
+    for (auto p_E: proportions) {
+        if (p_E < 0 or p_E > 1) throw std::domain_error("The percentage of excitatory neurons should be between 0 and 1");
+    }
+    for (auto delta: deltas) {
+        if (delta < 0 or delta > 1) throw std::domain_error("The value of delta should be between 0 and 1");
+    }
+    //the runs sharing their connections follow each other, so that few networks are kept at the same time
+    for (auto p_E: proportions) {
+        for (auto lambda: lambdas) {
+            for (auto intensity: intensities) {
+                for (auto delta: deltas) {
+                    _points.push_back({intensity, lambda, p_E, delta});
+                    _groups.push_back(_remaining.size());
+                }
+            }
+            _remaining.push_back(intensities.size() * deltas.size());
+        }
+    }
+    _topologies.resize(_remaining.size());
+}
+
+std::map<char, std::vector<double>> Sweep::parseGrid(std::string grid) {
+    std::map<char, std::vector<double>> values;
+    grid.erase(std::remove_if(grid.begin(), grid.end(), isspace), grid.end());
+    std::stringstream parameters(grid);
+    std::string parameter;
+    while (std::getline(parameters, parameter, ';')) {
+        if (parameter.empty()) continue;
+        const size_t equal(parameter.find('='));
+        if (equal != 1 or std::string("Llpd").find(parameter[0]) == std::string::npos) {
+            throw std::domain_error("The sweep can only be done over L, l, p and d, given as key=values: " + parameter);
+        }
+        std::vector<double>& axis(values[parameter[0]]);
+        axis.clear();
+        try {
+            std::stringstream list(parameter.substr(2));
+            std::string value;
+            while (std::getline(list, value, ',')) {
+                size_t colon(value.find(':'));
+                if (colon == std::string::npos) {
+                    axis.push_back(std::stod(value));
+                    continue;
+                }
+                const size_t second(value.find(':', colon + 1));
+                if (second == std::string::npos) throw std::invalid_argument(value);
+                const double first(std::stod(value.substr(0, colon)));
+                const double last(std::stod(value.substr(colon + 1, second - colon - 1)));
+                const double step(std::stod(value.substr(second + 1)));
+                if (step <= 0) throw std::domain_error("The step of a range of the sweep must be positive: " + value);
+                //the last value is included despite rounding errors
+                for (int k(0); first + k*step <= last + 1e-9*step; k++) {
+                    axis.push_back(first + k*step);
+                }
+            }
+        } catch (const std::invalid_argument&) {
+            throw std::domain_error("The values of the sweep cannot be read: " + parameter);
+        }
+        if (axis.empty()) {
+            throw std::domain_error("No value is given for a parameter of the sweep: " + parameter);
+        }
+    }
+    if (values.empty()) {
+        throw std::domain_error("The sweep needs at least one parameter");
+    }
+    return values;
+}
+
+std::string Sweep::outputFile(size_t run) const {
+    return Simulation::numberedFile(_output, run, _points.size());
+}
+
+std::string Sweep::indexFile() const {
+    return _output.substr(0, _output.rfind('.')) + "_index" + _EXTENSION_;
+}
+
+Network* Sweep::makeNetwork(size_t run) {
+    const Point& point(_points[run]);
+    const size_t group(_groups[run]);
+    if (not _topologies[group]) {
+        *_RNG = Random(Random::counter_hash(_seed, group, 0));
+        _topologies[group].reset(new Network(_model, _nb, point.p_E, point.intensity, point.lambda, point.delta, *_RNG, _construction));
+    }
+    *_RNG = Random(Random::counter_hash(_seed, run, 1));
+    std::unique_ptr<Network> net(new Network(*_topologies[group], point.intensity, point.delta, *_RNG));
+    //the noise seed of the synchronous update is drawn here
+    net->setPropagation(_propagation);
+    net->setSynchronous(true);
+    _remaining[group] -= 1;
+    if (_remaining[group] == 0) {
+        _topologies[group].reset();
+    }
+    return net.release();
+}
+
+double Sweep::run() {
+    const auto start(std::chrono::steady_clock::now());
+    const std::string state(_RNG->getState());
+    std::vector<double> seconds(_points.size(), 0);
+    ThreadPool pool(_threads);
+    pool.run(_points.size(), [this, &seconds] (size_t run) {
+        std::unique_ptr<Simulation> simulation;
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            simulation.reset(new Simulation(makeNetwork(run), outputFile(run), _format, _time));
+        }
+        seconds[run] = simulation->run();
+    });
+    _RNG->setState(state);
+    std::ofstream index(indexFile());
+    if (not index.is_open()) {
+        throw std::runtime_error("The index file " + indexFile() + " cannot be written");
+    }
+    index << "run\t output\t L\t lambda\t p_E\t delta\t network\t seed\t seconds\n";
+    for (size_t run(0); run < _points.size(); run++) {
+        const Point& point(_points[run]);
+        index << run << "\t" << outputFile(run) << "\t" << point.intensity << "\t" << point.lambda << "\t" << point.p_E << "\t"
+              << point.delta << "\t" << _groups[run] << "\t" << Random::counter_hash(_seed, run, 1) << "\t" << seconds[run] << "\n";
+    }
+    //the outputs of the runs are counted by their simulations
+    if (PROFILE_ENABLED()) {
+        index.flush();
+        Profiler::instance().count(Profiler::BYTES, index.tellp());
+    }
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
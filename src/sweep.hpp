@@ -0,0 +1,105 @@
+#ifndef SWEEP_HPP
+#define SWEEP_HPP
+#include <vector>
+#include <map>
+#include <string>
+#include <memory>
+#include <mutex>
+#include <cstdint>
+#include "network.hpp"
+
+
+/**
+ * @brief Runs a grid of simulations over the mean intensity (L), the mean connectivity (l), the proportion of excitatory neurons (p)
+ * and the variability of the neurons (d), in one process.
+ *
+ * The runs are independent simulations shared out between the threads of a \ref ThreadPool.
+ * The runs with the same p and l share the connections of one network, built once (see \ref Network(const Network&, double, double)):
+ * only their neurons are drawn again, with their own d, and the intensities are scaled to their own L.
+ * Each run is synchronous, so that it does not draw from the shared generator once started,
+ * and the seeds of the networks and of the runs are derived from the seed of the generator: the results do not depend on the number of threads.
+ * Each run writes its spikes in its own file, and an index file lists the runs with their parameters.
+ */
+class Sweep {
+
+public:
+    /*! @brief Parameters of one run of the grid*/
+    struct Point {
+        ///mean intensity of a connection
+        double intensity;
+        ///mean connectivity
+        double lambda;
+        ///proportion of excitatory neurons
+        double p_E;
+        ///variability of the parameters of the neurons
+        double delta;
+    };
+
+    /*! @brief Prepares the runs of a grid
+     *  @param grid the values of each swept parameter, for instance "L=10,20,30;l=5:20:5;p=0.8;d=0.05" (see \ref parseGrid)
+     *  @param defaults the values of the parameters which are not swept
+     *  @param model the model of connection
+     *  @param nb the number of neurons
+     *  @param propagation 's' for a synchronous scan, or 'e' for events
+     *  @param construction the construction of the connections, 's' for sequential or 'p' for parallel
+     *  @param time the duration of each run, in ms
+     *  @param format the format of the output files (see \ref SpikeWriter)
+     *  @param output the name of the output file, the number of the run being added before its extension
+     *  @param threads the number of runs done at the same time
+     *  @note Throws a domain error if the grid or one of its values is not valid
+     */
+    Sweep(const std::string& grid, const Point& defaults, char model, int nb, char propagation, char construction,
+          double time, char format, const std::string& output, size_t threads);
+
+    /*! @brief Reads a grid: parameters separated by ';', each one being "key=values" with the key L, l, p or d,
+     *  and the values either separated by ',' or given as "first:last:step", the spaces being ignored
+     *  @note Throws a domain error if the grid cannot be read
+     */
+    static std::map<char, std::vector<double>> parseGrid(std::string grid);
+
+    /*! @brief Getter for the parameters of the runs, in their order*/
+    const std::vector<Point>& getPoints() const {return _points;};
+
+    /*! @brief Number of networks whose connections are built, one for each pair of p and l*/
+    size_t topologies() const {return _remaining.size();};
+
+    /*! @brief Name of the output file of a run*/
+    std::string outputFile(size_t run) const;
+
+    /*! @brief Name of the index file*/
+    std::string indexFile() const;
+
+    /*! @brief Does all runs, then writes the index file
+     *  @return the execution time, in seconds
+     */
+    double run();
+
+private:
+    /*! @brief Builds the network of a run, sharing the connections of its group, built by the first run of the group
+     *  @note Only called by one thread at a time, as the networks draw from the shared generator
+     */
+    Network* makeNetwork(size_t run);
+
+    std::vector<Point> _points;
+    ///group of each run, the runs of a group sharing their connections
+    std::vector<size_t> _groups;
+    ///network of each group whose connections are shared, kept until the network of its last run is built
+    std::vector<std::unique_ptr<Network>> _topologies;
+    ///number of runs of each group whose network is not built yet
+    std::vector<size_t> _remaining;
+    char _model;
+    int _nb;
+    char _propagation;
+    char _construction;
+    double _time;
+    char _format;
+    ///name of the output file, numbered for each run
+    std::string _output;
+    size_t _threads;
+    ///seed from which the seeds of the networks and of the runs are derived
+    uint64_t _seed;
+    ///protects the shared generator and the networks of the groups
+    std::mutex _mutex;
+};
+
+#endif //SWEEP_HPP
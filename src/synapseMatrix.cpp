@@ -0,0 +1,274 @@
+#include "synapseMatrix.hpp"
+#include <algorithm>
+#include <cmath>
+#include <numeric>
+#include <stdexcept>
+#include <string>
+#include <utility>
+
+namespace {
+
+//intensities of the connections of another matrix, taken at the given positions
+template<class W>
+std::vector<W> gather(const W* weights, const std::vector<size_t>& moved) {
+    std::vector<W> result(moved.size());
+    for (size_t k(0); k < moved.size(); ++k) {
+        result[k] = weights[moved[k]];
+    }
+    return result;
+}
+
+}
+
+SynapseMatrix::SynapseMatrix()
+    : SynapseMatrix(std::vector<size_t>(1, 0), {}, {})
+{}
+
+SynapseMatrix::SynapseMatrix(std::vector<size_t> offsets, std::vector<int> sources, std::vector<double> weights)
+{
+    if (offsets.empty() or offsets.back() != sources.size() or sources.size() != weights.size()) {
+        throw std::invalid_argument("The arrays given do not describe a sparse matrix");
+    }
+    std::vector<size_t> order;
+    std::vector<int> sortedSources;
+    std::vector<double> sortedWeights;
+    for (size_t row(0); row + 1 < offsets.size(); ++row) {
+        int* first(sources.data() + offsets[row]);
+        int* last(sources.data() + offsets[row + 1]);
+        if (std::is_sorted(first, last)) continue;
+        //sorts the row through a permutation, to keep each intensity with its neuron
+        order.resize(last - first);
+        std::iota(order.begin(), order.end(), 0);
+        std::sort(order.begin(), order.end(), [first](size_t i, size_t j) {return first[i] < first[j];});
+        double* weight(weights.data() + offsets[row]);
+        sortedSources.clear();
+        sortedWeights.clear();
+        for (auto k: order) {
+            sortedSources.push_back(first[k]);
+            sortedWeights.push_back(weight[k]);
+        }
+        std::copy(sortedSources.begin(), sortedSources.end(), first);
+        std::copy(sortedWeights.begin(), sortedWeights.end(), weight);
+    }
+    std::shared_ptr<Arrays> arrays(new Arrays{std::move(offsets), std::move(sources)});
+    _rows = arrays->offsets.size() - 1;
+    _offsets = arrays->offsets.data();
+    _sources = arrays->sources.data();
+    _owner = arrays;
+    own(std::move(weights));
+}
+
+SynapseMatrix::SynapseMatrix(size_t rows, const size_t* offsets, const int* sources, const double* weights, std::shared_ptr<const void> owner)
+    : _owner(owner), _weightsOwner(std::move(owner)), _rows(rows), _offsets(offsets), _sources(sources),
+      _precision('d'), _weights(weights), _weights32(nullptr), _weights16(nullptr), _unit(1)
+{
+    if (offsets == nullptr or offsets[0] != 0) {
+        throw std::invalid_argument("The arrays given do not describe a sparse matrix");
+    }
+}
+
+SynapseMatrix::SynapseMatrix(std::shared_ptr<Arrays> arrays)
+    : _owner(arrays), _rows(arrays->offsets.size() - 1), _offsets(arrays->offsets.data()), _sources(arrays->sources.data()),
+      _precision('d'), _weights(nullptr), _weights32(nullptr), _weights16(nullptr), _unit(1)
+{}
+
+void SynapseMatrix::own(std::vector<double> weights) {
+    std::shared_ptr<std::vector<double>> owned(std::make_shared<std::vector<double>>(std::move(weights)));
+    _precision = 'd';
+    _weights = owned->data();
+    _weights32 = nullptr;
+    _weights16 = nullptr;
+    _unit = 1;
+    _weightsOwner = owned;
+}
+
+void SynapseMatrix::own(std::vector<float> weights) {
+    std::shared_ptr<std::vector<float>> owned(std::make_shared<std::vector<float>>(std::move(weights)));
+    _precision = 'f';
+    _weights = nullptr;
+    _weights32 = owned->data();
+    _weights16 = nullptr;
+    _unit = 1;
+    _weightsOwner = owned;
+}
+
+void SynapseMatrix::own(std::vector<int16_t> weights, double unit) {
+    std::shared_ptr<std::vector<int16_t>> owned(std::make_shared<std::vector<int16_t>>(std::move(weights)));
+    _precision = 'h';
+    _weights = nullptr;
+    _weights32 = nullptr;
+    _weights16 = owned->data();
+    _unit = unit;
+    _weightsOwner = owned;
+}
+
+bool SynapseMatrix::connected(size_t row, int source) const {
+    return std::binary_search(sources(row), sources(row) + degree(row), source);
+}
+
+double SynapseMatrix::valence(size_t row) const {
+    double input(0);
+    for (size_t k(_offsets[row]); k < _offsets[row + 1]; ++k) {
+        input += value(k);
+    }
+    return input;
+}
+
+SynapseMatrix SynapseMatrix::transpose() const {
+    std::vector<size_t> offsets(size() + 1, 0);
+    for (size_t k(0); k < nonZeros(); ++k) {
+        offsets[_sources[k] + 1] += 1;
+    }
+    std::partial_sum(offsets.begin(), offsets.end(), offsets.begin());
+    std::vector<size_t> position(offsets.begin(), offsets.end() - 1);
+    std::vector<int> targets(nonZeros());
+    std::vector<size_t> moved(nonZeros());
+    //rows are read in increasing order, so the transposed rows are filled already sorted
+    for (size_t row(0); row < size(); ++row) {
+        for (size_t k(_offsets[row]); k < _offsets[row + 1]; ++k) {
+            size_t& next(position[_sources[k]]);
+            targets[next] = row;
+            moved[next] = k;
+            next += 1;
+        }
+    }
+    return gathered(std::move(offsets), std::move(targets), moved);
+}
+
+std::vector<int> SynapseMatrix::reverseCuthillMcKee() const {
+    //the neighbours of a neuron are the ones it receives connections from and the ones it connects to
+    const SynapseMatrix outgoing(transpose());
+    std::vector<size_t> degrees(size());
+    for (size_t row(0); row < size(); ++row) {
+        degrees[row] = degree(row) + outgoing.degree(row);
+    }
+    auto lower = [&degrees](int i, int j) {return degrees[i] < degrees[j];};
+    std::vector<int> byDegree(size());
+    std::iota(byDegree.begin(), byDegree.end(), 0);
+    std::stable_sort(byDegree.begin(), byDegree.end(), lower);
+    std::vector<int> order;
+    order.reserve(size());
+    std::vector<bool> visited(size(), false);
+    std::vector<int> neighbours;
+    for (auto start: byDegree) {
+        if (visited[start]) continue;
+        //the order itself is the queue of the breadth-first search of the component
+        visited[start] = true;
+        order.push_back(start);
+        for (size_t head(order.size() - 1); head < order.size(); ++head) {
+            const int row(order[head]);
+            neighbours.clear();
+            for (const SynapseMatrix* matrix: {this, &outgoing}) {
+                for (size_t k(0); k < matrix->degree(row); ++k) {
+                    const int next(matrix->source(row, k));
+                    if (not visited[next]) {
+                        visited[next] = true;
+                        neighbours.push_back(next);
+                    }
+                }
+            }
+            std::stable_sort(neighbours.begin(), neighbours.end(), lower);
+            order.insert(order.end(), neighbours.begin(), neighbours.end());
+        }
+    }
+    std::reverse(order.begin(), order.end());
+    return order;
+}
+
+SynapseMatrix SynapseMatrix::permute(const std::vector<int>& order) const {
+    if (order.size() != size()) {
+        throw std::invalid_argument("The order given is not a permutation of the rows");
+    }
+    std::vector<int> position(size(), -1);
+    for (size_t n(0); n < order.size(); ++n) {
+        if (order[n] < 0 or size_t(order[n]) >= size() or position[order[n]] != -1) {
+            throw std::invalid_argument("The order given is not a permutation of the rows");
+        }
+        position[order[n]] = n;
+    }
+    std::vector<size_t> offsets(size() + 1, 0);
+    std::vector<int> sources;
+    std::vector<size_t> moved;
+    sources.reserve(nonZeros());
+    moved.reserve(nonZeros());
+    std::vector<std::pair<int, size_t>> row;
+    for (size_t n(0); n < size(); ++n) {
+        //the row is sorted again by the new indices
+        row.clear();
+        for (size_t k(_offsets[order[n]]); k < _offsets[order[n] + 1]; ++k) {
+            row.emplace_back(position[_sources[k]], k);
+        }
+        std::sort(row.begin(), row.end());
+        for (const auto& connection: row) {
+            sources.push_back(connection.first);
+            moved.push_back(connection.second);
+        }
+        offsets[n + 1] = sources.size();
+    }
+    return gathered(std::move(offsets), std::move(sources), moved);
+}
+
+SynapseMatrix SynapseMatrix::gathered(std::vector<size_t> offsets, std::vector<int> sources, const std::vector<size_t>& moved) const {
+    SynapseMatrix matrix(std::make_shared<Arrays>(Arrays{std::move(offsets), std::move(sources)}));
+    if (_precision == 'f') {
+        matrix.own(gather(_weights32, moved));
+    }
+    else if (_precision == 'h') {
+        matrix.own(gather(_weights16, moved), _unit);
+    }
+    else {
+        matrix.own(gather(_weights, moved));
+    }
+    return matrix;
+}
+
+SynapseMatrix SynapseMatrix::withPrecision(char precision) const {
+    if (precision != 'd' and precision != 'f' and precision != 'h') {
+        throw std::invalid_argument(std::string("The precision ") + precision + " does not exist");
+    }
+    SynapseMatrix matrix(*this);
+    if (precision == _precision) {
+        return matrix;
+    }
+    if (precision == 'd') {
+        std::vector<double> weights(nonZeros());
+        for (size_t k(0); k < nonZeros(); ++k) {
+            weights[k] = value(k);
+        }
+        matrix.own(std::move(weights));
+    }
+    else if (precision == 'f') {
+        std::vector<float> weights(nonZeros());
+        for (size_t k(0); k < nonZeros(); ++k) {
+            weights[k] = value(k);
+        }
+        matrix.own(std::move(weights));
+    }
+    else {
+        double largest(0);
+        for (size_t k(0); k < nonZeros(); ++k) {
+            largest = std::max(largest, std::abs(value(k)));
+        }
+        //smallest power of two whose largest multiple reaches the largest intensity
+        int exponent(0);
+        std::frexp(largest / INT16_MAX, &exponent);
+        double unit(largest > 0 ? std::ldexp(1.0, exponent) : 1);
+        while (unit * INT16_MAX < largest) {
+            unit *= 2;
+        }
+        while (largest > 0 and unit / 2 * INT16_MAX >= largest) {
+            unit /= 2;
+        }
+        std::vector<int16_t> weights(nonZeros());
+        for (size_t k(0); k < nonZeros(); ++k) {
+            weights[k] = int16_t(std::lround(value(k) / unit));
+        }
+        matrix.own(std::move(weights), unit);
+    }
+    return matrix;
+}
+
+size_t SynapseMatrix::bytes() const {
+    const size_t weight(_precision == 'f' ? sizeof(float) : (_precision == 'h' ? sizeof(int16_t) : sizeof(double)));
+    return (_rows + 1)*sizeof(size_t) + nonZeros()*(sizeof(int) + weight);
+}
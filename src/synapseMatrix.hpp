@@ -0,0 +1,187 @@
+#ifndef SYNAPSEMATRIX_HPP
+#define SYNAPSEMATRIX_HPP
+#include <vector>
+#include <memory>
+#include <cstddef>
+#include <cstdint>
+
+
+/**
+ * @brief Immutable sparse matrix of the connections of a network, in compressed sparse row (CSR) format.
+ *
+ * Row i holds the connections received by the neuron i: the indices of the neurons it is connected to
+ * and the intensities of these connections, in two flat arrays shared by all rows.
+ * Within a row, the connections are sorted by increasing index of the connected neuron.
+ * The arrays are either owned by the matrix, or stored elsewhere (for instance in a mapped file) and only viewed;
+ * as they are never modified, the copies of a matrix share them.
+ * The intensities are stored in double, or only in a reduced precision (see \ref withPrecision), in which case they are
+ * read through \ref weights32 or \ref weights16 and converted back to double by \ref weight and \ref valence.
+ */
+class SynapseMatrix {
+
+public:
+    /*! @brief Constructs an empty matrix (no rows)*/
+    SynapseMatrix();
+
+    /*! @brief Constructs the matrix from its CSR arrays.
+     *  @param offsets the position of the first connection of each row in the other arrays, followed by the total number of connections
+     *  @param sources the index of the connected neuron, for each connection
+     *  @param weights the intensity, for each connection
+     *  @note The rows are sorted here if they are not already.
+     */
+    SynapseMatrix(std::vector<size_t> offsets, std::vector<int> sources, std::vector<double> weights);
+
+    /*! @brief Constructs a view on CSR arrays stored elsewhere, without copying them.
+     *  @param rows the number of rows
+     *  @param offsets,sources,weights the arrays, as for the other constructor, the rows being already sorted
+     *  @param owner the object keeping the arrays alive, released when the last copy of the matrix is destroyed
+     */
+    SynapseMatrix(size_t rows, const size_t* offsets, const int* sources, const double* weights, std::shared_ptr<const void> owner);
+
+    /*! @brief Number of rows, i.e. of neurons receiving connections*/
+    size_t size() const {return _rows;};
+
+    /*! @brief Total number of connections*/
+    size_t nonZeros() const {return _offsets[_rows];};
+
+    /*! @brief Number of connections received by a neuron
+     *  @param row the index of the neuron
+     */
+    size_t degree(size_t row) const {return _offsets[row + 1] - _offsets[row];};
+
+    /*! @brief Indices of the neurons connected to a neuron
+     *  @param row the index of the neuron
+     *  @return a pointer to the degree(row) indices of the row
+     */
+    const int* sources(size_t row) const {return _sources + _offsets[row];};
+
+    /*! @brief Intensities of the connections received by a neuron
+     *  @param row the index of the neuron
+     *  @return a pointer to the degree(row) intensities of the row, in the order of \ref sources
+     *  @note Only valid in double precision
+     */
+    const double* weights(size_t row) const {return _weights + _offsets[row];};
+
+    /*! @brief Index of the neuron of the k-th connection of a row*/
+    int source(size_t row, size_t k) const {return _sources[_offsets[row] + k];};
+
+    /*! @brief Intensity of the k-th connection of a row, in double whatever the precision of the matrix*/
+    double weight(size_t row, size_t k) const {return value(_offsets[row] + k);};
+
+    /*! @brief Tells if a neuron receives a connection from another one
+     *  @param row the index of the receiving neuron
+     *  @param source the index of the other neuron
+     */
+    bool connected(size_t row, int source) const;
+
+    /*! @brief Sum of the intensities of the connections of a row
+     *  @param row the index of the neuron
+     */
+    double valence(size_t row) const;
+
+    /*! @brief Builds the transposed matrix.
+     *  Row j of the transposed matrix holds the connections made by the neuron j:
+     *  the indices of the neurons receiving them and their intensities.
+     *  @return the transposed matrix, with rows sorted by increasing index as well
+     */
+    SynapseMatrix transpose() const;
+
+    /*! @brief Orders the rows by the reverse Cuthill-McKee algorithm, so that connected neurons get close indices.
+     *  The connections are taken in both directions. Each connected component is walked breadth-first from its neuron of lowest degree,
+     *  the neighbours of a neuron being visited by increasing degree, and the whole order is then reversed.
+     *  @return the row placed at each position, to be given to \ref permute
+     */
+    std::vector<int> reverseCuthillMcKee() const;
+
+    /*! @brief Builds the matrix of the same connections with the neurons in another order
+     *  @param order the former index of the neuron placed at each position, a permutation of the rows
+     *  @return the matrix whose row n is the former row order[n], the indices of the connected neurons being replaced by their new positions,
+     *  with rows sorted by increasing index as well
+     *  @note Throws an invalid argument if the order is not a permutation of the rows
+     */
+    SynapseMatrix permute(const std::vector<int>& order) const;
+
+    /*! @brief Builds the matrix of the same connections with the intensities stored in another precision.
+     *  The offsets and the sources are shared with this matrix, the intensities being the only array built.
+     *  In <b>float</b> ('f'), each intensity is rounded to the nearest float. In <b>16-bit fixed point</b> ('h'), it is rounded to
+     *  a multiple of the \ref unit, the smallest power of two whose 32767 multiples reach the largest intensity in absolute value,
+     *  so that the intensities converted back to double are encoded again into the same integers.
+     *  The intensities in double of a reduced matrix are the rounded ones.
+     *  @param precision 'd', 'f' or 'h'
+     *  @note Throws an invalid argument if the precision does not exist
+     */
+    SynapseMatrix withPrecision(char precision) const;
+
+    /*! @brief Precision in which the intensities are stored, 'd', 'f' or 'h'*/
+    char precision() const {return _precision;};
+
+    /*! @brief Intensity of one unit of the 16-bit fixed point intensities, 1 in the other precisions*/
+    double unit() const {return _unit;};
+
+    /*! @brief Memory taken by the arrays of the matrix, in bytes*/
+    size_t bytes() const;
+
+    /*! @brief The whole CSR arrays, for instance to save them
+     *  @return the size()+1 offsets, and the nonZeros() sources and intensities
+     */
+    const size_t* offsets() const {return _offsets;};
+    const int* sources() const {return _sources;};
+    const double* weights() const {return _weights;};
+
+    /*! @brief All the intensities, in the order of \ref sources, only valid in the precision of their type ('f' or 'h')*/
+    const float* weights32() const {return _weights32;};
+    const int16_t* weights16() const {return _weights16;};
+
+private:
+    /*! @brief Offsets and sources owned by a matrix*/
+    struct Arrays {
+        std::vector<size_t> offsets;
+        std::vector<int> sources;
+    };
+
+    /*! @brief Constructs a matrix owning its offsets and sources, sorted, and no intensities yet*/
+    explicit SynapseMatrix(std::shared_ptr<Arrays> arrays);
+
+    /*! @brief Gives the matrix its own intensities, which set its precision
+     *  @param weights the intensities, in double, float or 16-bit integers
+     *  @param unit the intensity of one unit of the 16-bit integers
+     */
+    void own(std::vector<double> weights);
+    void own(std::vector<float> weights);
+    void own(std::vector<int16_t> weights, double unit);
+
+    /*! @brief Builds the matrix of the given offsets and sources, already sorted, the intensity of each connection being the one of another connection
+     *  @param offsets,sources the CSR arrays of the new matrix
+     *  @param moved the position in this matrix of the intensity of each connection of the new one
+     *  @return the matrix, with the precision of this matrix
+     */
+    SynapseMatrix gathered(std::vector<size_t> offsets, std::vector<int> sources, const std::vector<size_t>& moved) const;
+
+    /*! @brief Intensity in double of the connection at a position of the flat arrays*/
+    double value(size_t position) const {
+        return _precision == 'f' ? _weights32[position] : (_precision == 'h' ? _unit*_weights16[position] : _weights[position]);
+    };
+
+    ///Owner of the offsets and the sources, shared by the copies of the matrix
+    std::shared_ptr<const void> _owner;
+    ///Owner of the intensities, released apart from the other arrays when a matrix in another precision replaces this one
+    std::shared_ptr<const void> _weightsOwner;
+    ///Number of rows
+    size_t _rows;
+    ///Position of the first connection of each row, the last element being the number of connections
+    const size_t* _offsets;
+    ///Index of the connected neuron of each connection
+    const int* _sources;
+    ///Precision of the intensities, 'd', 'f' or 'h'
+    char _precision;
+    ///Intensity of each connection in double precision, nullptr in the others
+    const double* _weights;
+    ///Intensity of each connection in float precision, nullptr in the others
+    const float* _weights32;
+    ///Intensity of each connection in 16-bit fixed point, nullptr in the other precisions
+    const int16_t* _weights16;
+    ///Intensity of one unit of \ref _weights16
+    double _unit;
+};
+
+#endif //SYNAPSEMATRIX_HPP
@@ -0,0 +1,77 @@
+#include "threadPool.hpp"
+
+ThreadPool::ThreadPool(size_t threads)
+    : _task(nullptr), _tasks(0), _next(0), _busy(0), _batch(0), _stop(false)
+{
+    for (size_t i(1); i < threads; ++i) {
+        _workers.push_back(std::thread(&ThreadPool::work, this));
+    }
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _stop = true;
+    }
+    _start.notify_all();
+    for (auto& worker: _workers) {
+        worker.join();
+    }
+}
+
+void ThreadPool::run(size_t tasks, const std::function<void(size_t)>& task) {
+    if (_workers.empty() or tasks < 2) {
+        for (size_t i(0); i < tasks; ++i) {
+            task(i);
+        }
+        return;
+    }
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _task = &task;
+        _tasks = tasks;
+        _next = 0;
+        _busy = _workers.size();
+        _error = nullptr;
+        _batch += 1;
+    }
+    _start.notify_all();
+    runTasks();
+    std::unique_lock<std::mutex> lock(_mutex);
+    _done.wait(lock, [this] {return _busy == 0;});
+    _task = nullptr;
+    if (_error) {
+        std::rethrow_exception(_error);
+    }
+}
+
+void ThreadPool::work() {
+    size_t batch(0);
+    while (true) {
+        {
+            std::unique_lock<std::mutex> lock(_mutex);
+            _start.wait(lock, [this, batch] {return _stop or _batch != batch;});
+            if (_stop) return;
+            batch = _batch;
+        }
+        runTasks();
+        std::lock_guard<std::mutex> lock(_mutex);
+        if (--_busy == 0) {
+            _done.notify_one();
+        }
+    }
+}
+
+void ThreadPool::runTasks() {
+    for (size_t i(_next++); i < _tasks; i = _next++) {
+        try {
+            (*_task)(i);
+        } catch (...) {
+            std::lock_guard<std::mutex> lock(_mutex);
+            if (not _error) {
+                _error = std::current_exception();
+            }
+            _next = _tasks;
+        }
+    }
+}
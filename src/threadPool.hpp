@@ -0,0 +1,70 @@
+#ifndef THREADPOOL_HPP
+#define THREADPOOL_HPP
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#include <atomic>
+#include <cstddef>
+
+
+/**
+ * @brief A fixed set of threads running numbered tasks.
+ *
+ * The threads are created once and wait between two calls to \ref run, so that
+ * a simulation step can be split between them without creating threads at each step.
+ * The thread calling \ref run takes part in the work.
+ */
+class ThreadPool {
+
+public:
+    /*! @brief Creates the threads
+     *  @param threads the total number of threads working on the tasks, including the calling one
+     */
+    ThreadPool(size_t threads);
+
+    /*! @brief Waits for the threads to finish and joins them*/
+    ~ThreadPool();
+
+    /*! @brief Runs the tasks 0 to tasks-1, and returns when they are all done.
+     *  Tasks are handed out one at a time to the first available thread.
+     *  @param tasks the number of tasks
+     *  @param task the function to call with the number of each task
+     *  @note The first exception thrown by a task is thrown again here, once all threads stopped working.
+     */
+    void run(size_t tasks, const std::function<void(size_t)>& task);
+
+    /*! @brief Total number of threads working on the tasks*/
+    size_t size() const {return _workers.size() + 1;};
+
+private:
+    /*! @brief Loop of each worker thread, waiting for a new batch of tasks*/
+    void work();
+
+    /*! @brief Runs tasks of the current batch until there is none left*/
+    void runTasks();
+
+    ///threads other than the calling one
+    std::vector<std::thread> _workers;
+    std::mutex _mutex;
+    ///signals a new batch of tasks, or the destruction of the pool
+    std::condition_variable _start;
+    ///signals the end of a batch
+    std::condition_variable _done;
+    ///function of the current batch
+    const std::function<void(size_t)>* _task;
+    ///number of tasks of the current batch
+    size_t _tasks;
+    ///next task to be handed out
+    std::atomic<size_t> _next;
+    ///number of workers still running tasks of the current batch
+    size_t _busy;
+    ///number of the current batch, to wake the workers only once per batch
+    size_t _batch;
+    ///first exception thrown by a task of the current batch
+    std::exception_ptr _error;
+    bool _stop;
+};
+
+#endif //THREADPOOL_HPP
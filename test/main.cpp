@@ -4,56 +4,74 @@
 #include "../src/constants.hpp"
 #include "../src/excitatoryNeuron.hpp"
 #include "../src/inhibitoryNeuron.hpp"
+#include "../src/threadPool.hpp"
+#include "../src/outputQueue.hpp"
+#include "../src/spikeWriter.hpp"
+#include "../src/profiler.hpp"
+#include "../src/sweep.hpp"
+#include "../src/replicaBatch.hpp"
+#include "../src/spikeStatistics.hpp"
+#include "../src/distributedNetwork.hpp"
+#include "../src/engine.hpp"
+#include <sstream>
 #include <cmath>
 #include <vector>
 #include <map>
 #include <fstream>
 #include <string>
+#include <numeric>
+#include <random>
+#include <cstring>
+#include <iterator>
 
-Random* _RNG = new Random(23948710923);
+//seed of the generators given to the classes of the library, and of the generator of the program for the simulations
+const uint64_t SEED(23948710923);
+Random* _RNG = new Random(SEED);
 
 TEST(Random, distributions) {
+    Random random(SEED);
     double mean = 0;
     double input_mean(1.35), input_sd(2.8);
     std::vector<double> res;
     res.resize(10000);
     double delta = input_sd*sqrt(3.0);
     double lower = input_mean-delta, upper = input_mean+delta;
-    _RNG->uniform_double(res, lower, upper);
+    random.uniform_double(res, lower, upper);
     for (auto I : res) {
         EXPECT_GE(I, lower);
         EXPECT_LT(I, upper);
         mean += I*1e-4;
     }
     EXPECT_NEAR(input_mean, mean, 3e-2*input_sd);
-    _RNG->normal(res, input_mean, input_sd);
+    random.normal(res, input_mean, input_sd);
     mean = 0;
     for (auto I : res) mean += I*1e-4;
     EXPECT_NEAR(input_mean, mean, 2e-2*input_sd);
-    _RNG->poisson(res, input_mean);
+    random.poisson(res, input_mean);
     mean = 0;
     for (auto I : res) mean += I*1e-4;
     EXPECT_NEAR(input_mean, mean, 2e-2*input_mean);
 }
 
 TEST(Network, connections) {
-    Network net(_MOD_, _NB_TEST_, _PERC_, _INT_, _LAMB_, _DEL_);
+    Random random(SEED);
+    Network net(_MOD_, _NB_TEST_, _PERC_, _INT_, _LAMB_, _DEL_, random);
     std::vector<Neuron*> netw(net.getNet());
-    std::vector<std::map<Neuron*, double>> con(net.getCon());
+    const SynapseMatrix& con(net.getCon());
 
     //test création Network
     EXPECT_FALSE(netw.empty());
-    EXPECT_FALSE(con.empty());
+    EXPECT_FALSE(con.size() == 0);
 
     //test bon nombre neurones crées
     EXPECT_EQ(_NB_TEST_, netw.size());
     EXPECT_EQ(con.size(), netw.size());
 
-    //test association map/neurone
+    //test association ligne/neurone
     int problems(0);
-    for (size_t i(0); i<netw.size(); ++i) {
-        for (auto pair : con[i]) {
-            if(pair.first == netw[i]) ++problems;
+    for (size_t i(0); i<con.size(); ++i) {
+        for (size_t k(0); k<con.degree(i); ++k) {
+            if(size_t(con.source(i, k)) == i) ++problems;
         }   
     }
     EXPECT_EQ(problems, 0);
@@ -64,35 +82,812 @@ TEST(Network, connections) {
         if (netw[i]==nullptr) ++sumNull;
     }
     EXPECT_EQ(sumNull, 0);
-    sumNull = 0;
+
+    //test indices valides, triés et sans doublon
+    int outOfRange(0);
     for (size_t i(0); i<con.size(); ++i) {
-        for (auto& pair : con[i]) {
-            if (pair.first == nullptr) ++sumNull;
+        for (size_t k(0); k<con.degree(i); ++k) {
+            if (con.source(i, k) < 0 or size_t(con.source(i, k)) >= netw.size()) ++outOfRange;
+            if (k > 0) {
+                EXPECT_LT(con.source(i, k-1), con.source(i, k));
+            }
+            EXPECT_TRUE(con.connected(i, con.source(i, k)));
         }
     }
-    EXPECT_EQ(sumNull, 0);
-    
+    EXPECT_EQ(outOfRange, 0);
+}
+
+TEST(Network, valence) {
+    Random random(SEED);
+    Network net(_MOD_, 100, _PERC_, _INT_, _LAMB_, _DEL_, random);
+    const SynapseMatrix& con(net.getCon());
+    size_t total(0);
+    for (size_t i(0); i<con.size(); ++i) {
+        double sum(0);
+        for (size_t k(0); k<con.degree(i); ++k) {
+            sum += con.weight(i, k);
+            double factor(net.getNet()[con.source(i, k)]->factor());
+            EXPECT_GE(con.weight(i, k)*factor, 0);
+            EXPECT_LE(std::abs(con.weight(i, k)), 2*_INT_);
+        }
+        EXPECT_DOUBLE_EQ(sum, net.getValence(i));
+        total += con.degree(i);
+    }
+    EXPECT_EQ(total, con.nonZeros());
+}
+
+TEST(Network, transpose) {
+    Random random(SEED);
+    Network net(_MOD_, 200, _PERC_, _INT_, _LAMB_, _DEL_, random);
+    const SynapseMatrix& con(net.getCon());
+    SynapseMatrix out(con.transpose());
+    EXPECT_EQ(out.size(), con.size());
+    EXPECT_EQ(out.nonZeros(), con.nonZeros());
+    for (size_t j(0); j<out.size(); ++j) {
+        for (size_t k(0); k<out.degree(j); ++k) {
+            int target(out.source(j, k));
+            EXPECT_TRUE(con.connected(target, j));
+            if (k > 0) {
+                EXPECT_LT(out.source(j, k-1), target);
+            }
+        }
+    }
+    SynapseMatrix back(out.transpose());
+    for (size_t i(0); i<con.size(); ++i) {
+        ASSERT_EQ(back.degree(i), con.degree(i));
+        for (size_t k(0); k<con.degree(i); ++k) {
+            EXPECT_EQ(back.source(i, k), con.source(i, k));
+            EXPECT_EQ(back.weight(i, k), con.weight(i, k));
+        }
+    }
+}
+
+TEST(Network, reorder) {
+    Random random(SEED);
+    //a shuffled chain gets back a bandwidth of 1
+    std::vector<int> shuffled(100);
+    std::iota(shuffled.begin(), shuffled.end(), 0);
+    std::shuffle(shuffled.begin(), shuffled.end(), std::mt19937(3));
+    std::vector<size_t> offsets(1, 0);
+    std::vector<int> sources;
+    for (int i(0); i < 100; ++i) {
+        for (int next: {i - 1, i + 1}) {
+            if (next >= 0 and next < 100) sources.push_back(next);
+        }
+        offsets.push_back(sources.size());
+    }
+    const SynapseMatrix chain(SynapseMatrix(offsets, sources, std::vector<double>(sources.size(), 1.0)).permute(shuffled));
+    const SynapseMatrix ordered(chain.permute(chain.reverseCuthillMcKee()));
+    for (size_t i(0); i < ordered.size(); ++i) {
+        for (size_t k(0); k < ordered.degree(i); ++k) {
+            EXPECT_EQ(std::abs(ordered.source(i, k) - int(i)), 1);
+        }
+    }
+    EXPECT_THROW(chain.permute(std::vector<int>(100, 0)), std::invalid_argument);
+
+    Network net('o', 300, .1, .1, .1, .1, .1, .1, _INT_, 20, _DEL_, random);
+    const SynapseMatrix con(net.getCon());
+    const NeuronPool neurons(net.getNeurons());
+    const size_t runs(net.getBlocks().size());
+    EXPECT_TRUE(net.getOrder().empty());
+    net.reorder();
+    const std::vector<int>& order(net.getOrder());
+    ASSERT_EQ(order.size(), 300);
+    std::vector<int> indices(300);
+    std::iota(indices.begin(), indices.end(), 0);
+    EXPECT_TRUE(std::is_permutation(order.begin(), order.end(), indices.begin()));
+    EXPECT_EQ(net.getBlocks().size(), runs);
+    std::vector<int> position(300);
+    for (size_t n(0); n < 300; ++n) {
+        position[order[n]] = n;
+        EXPECT_EQ(net.getNeurons().getType(n), neurons.getType(order[n]));
+        EXPECT_EQ(net.getNeurons().getAttributs(n), neurons.getAttributs(order[n]));
+    }
+    ASSERT_EQ(net.getCon().nonZeros(), con.nonZeros());
+    for (size_t n(0); n < 300; ++n) {
+        ASSERT_EQ(net.getCon().degree(n), con.degree(order[n]));
+        for (size_t k(0); k < con.degree(order[n]); ++k) {
+            EXPECT_TRUE(net.getCon().connected(n, position[con.source(order[n], k)]));
+        }
+        EXPECT_NEAR(net.getCon().valence(n), con.valence(order[n]), 1e-9);
+    }
+    //the spikes are given back in the original order, also by a snapshot of the reordered network
+    net.save("reorder_test.bin");
+    Network loaded("reorder_test.bin", random);
+    std::remove("reorder_test.bin");
+    EXPECT_EQ(loaded.getOrder(), order);
+    std::vector<uint64_t> spikes;
+    for (int step(0); step < 30; ++step) {
+        net.update();
+        net.getOriginalSpikes(spikes);
+        for (size_t n(0); n < 300; ++n) {
+            EXPECT_EQ((spikes[order[n] / 64] >> (order[n] % 64)) & 1, (net.getSpikes()[n / 64] >> (n % 64)) & 1);
+        }
+    }
+    //the noise of each neuron is the one of its original index, so a synchronous update gives the spikes of the network as built
+    for (char propagation: {'s', 'e'}) {
+        Random first(SEED), second(SEED);
+        Network built('o', 300, .1, .1, .1, .1, .1, .1, _INT_, 20, _DEL_, first);
+        Network reordered('o', 300, .1, .1, .1, .1, .1, .1, _INT_, 20, _DEL_, second);
+        reordered.reorder();
+        for (Network* network: {&built, &reordered}) {
+            network->setPropagation(propagation);
+            network->setSynchronous(true);
+        }
+        for (int step(0); step < 200; ++step) {
+            built.update();
+            reordered.update();
+            reordered.getOriginalSpikes(spikes);
+            ASSERT_EQ(spikes, built.getSpikes());
+        }
+        for (size_t n(0); n < 300; ++n) {
+            EXPECT_NEAR(reordered.getNeurons().getVariables(n)[0], built.getNeurons().getVariables(reordered.getOrder()[n])[0], 1e-9);
+        }
+    }
+}
+
+TEST(Network, otherConnections) {
+    Random random(SEED);
+    Network net('b', 100, .8, _INT_, 10, _DEL_, random);
+    net.reorder();
+    //a chain, each neuron receiving the connection of the previous one
+    std::vector<size_t> offsets(1, 0);
+    std::vector<int> sources;
+    for (int i(0); i < 100; ++i) {
+        if (i > 0) sources.push_back(i - 1);
+        offsets.push_back(sources.size());
+    }
+    const SynapseMatrix chain(offsets, sources, std::vector<double>(sources.size(), 2.0));
+    Network other(net, chain, random);
+    EXPECT_EQ(other.getOrder(), net.getOrder());
+    EXPECT_EQ(other.getBlocks().size(), net.getBlocks().size());
+    ASSERT_EQ(other.getCon().nonZeros(), 99);
+    for (size_t n(0); n < 100; ++n) {
+        EXPECT_EQ(other.getNeurons().getType(n), net.getNeurons().getType(n));
+        EXPECT_EQ(other.getNeurons().getAttributs(n), net.getNeurons().getAttributs(n));
+        EXPECT_EQ(other.getCon().degree(n), n > 0 ? 1 : 0);
+    }
+    EXPECT_THROW(Network(net, SynapseMatrix(std::vector<size_t>(51, 0), {}, {}), random), std::domain_error);
+    sources.back() = 100;
+    EXPECT_THROW(Network(net, SynapseMatrix(offsets, sources, std::vector<double>(sources.size(), 2.0)), random), std::domain_error);
+    other.setSynchronous(true);
+    for (int step(0); step < 20; ++step) other.update();
+}
+
+TEST(Network, construction) {
+    Random random(SEED);
+    std::vector<SynapseMatrix> built;
+    for (size_t threads: {1, 3}) {
+        Random seeded(7);
+        Network net('b', 300, _PERC_, _INT_, 50, _DEL_, seeded, 'p', threads);
+        built.push_back(net.getCon());
+    }
+    const SynapseMatrix& con(built[0]);
+    ASSERT_EQ(built[1].nonZeros(), con.nonZeros());
+    EXPECT_NEAR(double(con.nonZeros()) / con.size(), 50, 2);
+    for (size_t i(0); i<con.size(); ++i) {
+        ASSERT_EQ(built[1].degree(i), con.degree(i));
+        for (size_t k(0); k<con.degree(i); ++k) {
+            EXPECT_EQ(built[1].source(i, k), con.source(i, k));
+            EXPECT_EQ(built[1].weight(i, k), con.weight(i, k));
+            EXPECT_NE(size_t(con.source(i, k)), i);
+            if (k > 0) {
+                EXPECT_LT(con.source(i, k-1), con.source(i, k));
+            }
+        }
+    }
+    //a neuron can be connected to all the others
+    Network full('c', 20, _PERC_, _INT_, 19, _DEL_, random, 'p', 2);
+    for (size_t i(0); i<20; ++i) EXPECT_EQ(full.getCon().degree(i), 19);
+    Network over('o', 200, _PERC_, _INT_, 10, _DEL_, random, 'p', 2);
+    EXPECT_GT(over.getCon().nonZeros(), 0);
+    EXPECT_THROW(Network('b', 10, _PERC_, _INT_, 5, _DEL_, random, 'x'), std::domain_error);
+}
+
+TEST(Network, snapshot) {
+    Random random(SEED);
+    Network net('o', 300, .1, .1, .1, .1, .1, .1, _INT_, 20, _DEL_, random);
+    net.save("snapshot_test.bin");
+    Network loaded("snapshot_test.bin", random);
+    ASSERT_EQ(loaded.getNeurons().size(), 300);
+    for (size_t i(0); i < 300; ++i) {
+        EXPECT_EQ(loaded.getNeurons().getType(i), net.getNeurons().getType(i));
+        EXPECT_EQ(loaded.getNeurons().getAttributs(i), net.getNeurons().getAttributs(i));
+        EXPECT_EQ(loaded.getNeurons().getVariables(i), net.getNeurons().getVariables(i));
+        EXPECT_EQ(loaded.getNeurons().getW(i), net.getNeurons().getW(i));
+    }
+    for (size_t k(0); k < 7; ++k) {
+        ASSERT_NE(loaded.getNeuronsOutput()[k], nullptr);
+        EXPECT_EQ(loaded.getNeuronsOutput()[k]->getIndex(), net.getNeuronsOutput()[k]->getIndex());
+    }
+    const SynapseMatrix& con(net.getCon());
+    ASSERT_EQ(loaded.getCon().nonZeros(), con.nonZeros());
+    for (size_t i(0); i < con.size(); ++i) {
+        ASSERT_EQ(loaded.getCon().degree(i), con.degree(i));
+        for (size_t k(0); k < con.degree(i); ++k) {
+            EXPECT_EQ(loaded.getCon().source(i, k), con.source(i, k));
+            EXPECT_EQ(loaded.getCon().weight(i, k), con.weight(i, k));
+        }
+    }
+    //same evolution from the same draws of the generator kept by both networks
+    const std::string state(random.getState());
+    std::vector<std::vector<uint64_t>> spikes[2];
+    Network* nets[2] = {&net, &loaded};
+    for (int n(0); n < 2; ++n) {
+        random.setState(state);
+        for (int step(0); step < 50; ++step) {
+            nets[n]->update();
+            spikes[n].push_back(nets[n]->getSpikes());
+        }
+    }
+    EXPECT_EQ(spikes[0], spikes[1]);
+    std::remove("snapshot_test.bin");
+    std::ofstream wrong("snapshot_test.bin");
+    wrong << "not a snapshot";
+    wrong.close();
+    EXPECT_THROW(Network("snapshot_test.bin", random), std::runtime_error);
+    std::remove("snapshot_test.bin");
+}
+
+TEST(Network, corruptedSnapshot) {
+    Random random(SEED);
+    Network net('b', 100, _PERC_, _INT_, 10, _DEL_, random);
+    net.reorder();
+    net.save("snapshot_test.bin");
+    std::ifstream in("snapshot_test.bin", std::ios::binary);
+    const std::string bytes((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+    in.close();
+    //positions of the arrays of the snapshot
+    auto aligned = [](size_t size) {return (size + 63) / 64 * 64;};
+    const size_t nonZeros(net.getCon().nonZeros());
+    const size_t offsets(64 + aligned(100) + NeuronPool::COLUMNS * aligned(100 * 8));
+    const size_t sources(offsets + aligned(101 * 8));
+    const size_t order(sources + aligned(nonZeros * 4) + aligned(nonZeros * 8));
+    auto corrupt = [&bytes, &random](size_t position, uint64_t value, size_t size) {
+        std::string copy(bytes);
+        std::memcpy(&copy[position], &value, size);
+        std::ofstream out("snapshot_test.bin", std::ios::binary);
+        out << copy;
+        out.close();
+        EXPECT_THROW(Network("snapshot_test.bin", random), std::runtime_error);
+    };
+    corrupt(16, UINT64_MAX / 8 + 1, 8);
+    corrupt(24, UINT64_MAX / 4 + 1, 8);
+    corrupt(64 + 5, NEURON_TYPES, 1);
+    corrupt(offsets + 8, nonZeros + 1, 8);
+    corrupt(sources + 12, 100, 4);
+    corrupt(sources + 12, UINT32_MAX, 4);
+    corrupt(order + 4, *reinterpret_cast<const int32_t*>(&bytes[order]), 4);
+    std::remove("snapshot_test.bin");
+}
+
+TEST(Network, state) {
+    Random random(SEED);
+    for (char propagation: {'s', 'e'}) {
+        Network net(_MOD_, 200, _PERC_, _INT_, _LAMB_, _DEL_, random);
+        net.setPropagation(propagation);
+        for (int step(0); step < 20; ++step) net.update();
+        Checkpoint saved = {20, 20., "spikes.txt", 't', false, 10, 0, 0, random.getState(), net.getState(), 42};
+        saved.write("checkpoint_test.bin");
+        std::vector<std::vector<uint64_t>> spikes;
+        for (int step(0); step < 30; ++step) {
+            net.update();
+            spikes.push_back(net.getSpikes());
+        }
+        Checkpoint read(Checkpoint::read("checkpoint_test.bin"));
+        EXPECT_EQ(read.step, 20);
+        EXPECT_EQ(read.outputSize, 10);
+        EXPECT_EQ(read.seed, 42);
+        net.setPropagation('s');
+        random.setState(read.random);
+        net.setState(read.network);
+        EXPECT_EQ(net.getPropagation(), propagation);
+        for (int step(0); step < 30; ++step) {
+            net.update();
+            EXPECT_EQ(net.getSpikes(), spikes[step]);
+        }
+        std::remove("checkpoint_test.bin");
+    }
+    Network other(_MOD_, 10, _PERC_, _INT_, 2, _DEL_, random);
+    Network net(_MOD_, 20, _PERC_, _INT_, 2, _DEL_, random);
+    EXPECT_THROW(other.setState(net.getState()), std::runtime_error);
+}
+
+TEST(Profiler, phases) {
+    Random random(SEED);
+    Network net(_MOD_, 300, _PERC_, _INT_, _LAMB_, _DEL_, random);
+    const std::string state(net.getState());
+    const std::string noise(random.getState());
+    std::vector<std::vector<uint64_t>> spikes;
+    for (int step(0); step < 10; ++step) {
+        net.update();
+        spikes.push_back(net.getSpikes());
+    }
+    //the profiled update gives the same spikes
+    Profiler::instance().reset();
+    Profiler::instance().enable(true);
+    net.setState(state);
+    random.setState(noise);
+    for (int step(0); step < 10; ++step) {
+        net.update();
+        EXPECT_EQ(net.getSpikes(), spikes[step]);
+    }
+    Profiler::instance().enable(false);
+#ifdef PROFILING
+    EXPECT_EQ(Profiler::instance().getTimes(Profiler::CURRENT).size(), 10u);
+    EXPECT_EQ(Profiler::instance().getTimes(Profiler::UPDATE).size(), 10u);
+#endif
+    Profiler::instance().count(Profiler::STEPS, 10);
+    Profiler::instance().count(Profiler::SPIKES, 25);
+    std::ostringstream report;
+    Profiler::instance().report(report);
+    EXPECT_NE(report.str().find("2.5 per step"), std::string::npos);
+    Profiler::instance().reset();
+    EXPECT_TRUE(Profiler::instance().getTimes(Profiler::UPDATE).empty());
+    EXPECT_EQ(Profiler::instance().getCount(Profiler::SPIKES), 0u);
+}
+
+TEST(Network, shared) {
+    Random random(SEED);
+    Network topology(_MOD_, 200, _PERC_, 10, _LAMB_, _DEL_, random);
+    Network net(topology, 20, .1, random);
+    //the connections are shared and not copied
+    EXPECT_EQ(net.getCon().sources(), topology.getCon().sources());
+    ASSERT_EQ(net.getNeurons().size(), topology.getNeurons().size());
+    for (size_t i(0); i < 200; ++i) {
+        EXPECT_EQ(net.getNeurons().getType(i), topology.getNeurons().getType(i));
+        EXPECT_DOUBLE_EQ(net.getValence(i), 2*topology.getValence(i));
+    }
+    net.save("shared_test.bin");
+    Network loaded("shared_test.bin", random);
+    EXPECT_DOUBLE_EQ(loaded.getCon().valence(10), net.getValence(10));
+    std::remove("shared_test.bin");
+}
+
+TEST(Network, replicas) {
+    Random random(SEED);
+    Network net(_MOD_, 300, _PERC_, _INT_, _LAMB_, _DEL_, random);
+    EXPECT_THROW(ReplicaBatch(net, 4), std::domain_error);
+    net.setSynchronous(true);
+    EXPECT_THROW(ReplicaBatch(net, 65), std::domain_error);
+    ReplicaBatch batch(net, 5);
+    bool different(false);
+    for (int step(0); step < 30; ++step) {
+        net.update();
+        batch.update();
+        //the first replica continues the network itself
+        EXPECT_EQ(batch.getSpikes(0), net.getSpikes());
+        EXPECT_EQ(batch.getV(7, 0), net.getNeurons().getVariables(7)[0]);
+        different = different or batch.getSpikes(4) != net.getSpikes();
+    }
+    EXPECT_TRUE(different);
+}
+
+TEST(Network, blocks) {
+    Random random(SEED);
+    Network net(_MOD_, 100, .1, .2, 0, .1, 0, 0, _INT_, _LAMB_, _DEL_, random);
+    const std::vector<TypeBlock>& blocks(net.getBlocks());
+    ASSERT_EQ(blocks.size(), 4);
+    const std::vector<NeuronType> types = {NeuronType::FS, NeuronType::LTS, NeuronType::IB, NeuronType::RS};
+    int begin(0);
+    for (size_t k(0); k < blocks.size(); ++k) {
+        EXPECT_EQ(blocks[k].type, types[k]);
+        EXPECT_EQ(blocks[k].begin, begin);
+        EXPECT_TRUE(blocks[k].traits);
+        for (int i(blocks[k].begin); i < blocks[k].end; ++i) {
+            EXPECT_EQ(net.getNeurons().getType(i), typeTraits(types[k]).name);
+            EXPECT_EQ(net.getNeurons().getW(i), typeTraits(types[k]).w);
+        }
+        begin = blocks[k].end;
+    }
+    EXPECT_EQ(begin, 100);
+    EXPECT_EQ(neuronType("CH"), NeuronType::CH);
+    EXPECT_THROW(neuronType("XX"), std::domain_error);
+}
+
+TEST(Network, events) {
+    Random random(SEED);
+    Network net(_MOD_, 500, _PERC_, _INT_, _LAMB_, _DEL_, random);
+    net.setPropagation('e');
+    EXPECT_EQ(net.getPropagation(), 'e');
+    EXPECT_THROW(net.setPropagation('x'), std::domain_error);
+    size_t spikes(0);
+    for (int step(0); step < 100; ++step) {
+        net.update();
+        std::vector<bool> status(net.getCurrentstatus());
+        std::vector<int> fired;
+        for (size_t i(0); i<status.size(); ++i) {
+            if (status[i]) fired.push_back(i);
+        }
+        EXPECT_EQ(fired, net.getFired());
+        spikes += fired.size();
+    }
+    EXPECT_GT(spikes, 0);
+}
+
+TEST(Network, threads) {
+    //two identical networks, built from the same seed
+    Random first(1234), second(1234);
+    Network serial(_MOD_, 1000, _PERC_, _INT_, _LAMB_, _DEL_, first);
+    serial.setPropagation('e');
+    Network parallel(_MOD_, 1000, _PERC_, _INT_, _LAMB_, _DEL_, second);
+    parallel.setThreads(4);
+    parallel.setPropagation('e');
+    EXPECT_EQ(parallel.getThreads(), 4);
+    EXPECT_THROW(parallel.setThreads(0), std::domain_error);
+    for (int step(0); step < 100; ++step) {
+        serial.update();
+        parallel.update();
+        ASSERT_EQ(serial.getFired(), parallel.getFired());
+    }
+    for (size_t i(0); i < serial.getNeurons().size(); ++i) {
+        EXPECT_EQ(serial.getNeurons().getVariables(i), parallel.getNeurons().getVariables(i));
+    }
+}
+
+TEST(Network, delays) {
+    Random random(SEED);
+    //with delays of one step, the spikes arrive as in the synchronous update
+    Random first(999), second(999);
+    Network event(_MOD_, 1000, _PERC_, _INT_, _LAMB_, _DEL_, first);
+    event.setPropagation('e');
+    Network delayed(_MOD_, 1000, _PERC_, _INT_, _LAMB_, _DEL_, second);
+    delayed.setThreads(3);
+    delayed.setDelays(1, 5);
+    for (int step(0); step < 100; ++step) {
+        event.update();
+        delayed.update();
+        ASSERT_EQ(event.getFired(), delayed.getFired());
+    }
+
+    Network net(_MOD_, 500, _PERC_, _INT_, _LAMB_, _DEL_, random);
+    EXPECT_THROW(net.setDelays(0, 1), std::domain_error);
+    net.setDelays(5, 7);
+    EXPECT_EQ(net.getMaxDelay(), 5);
+    ASSERT_EQ(net.getDelays().size(), net.getCon().nonZeros());
+    EXPECT_EQ(*std::min_element(net.getDelays().begin(), net.getDelays().end()), 1);
+    EXPECT_EQ(*std::max_element(net.getDelays().begin(), net.getDelays().end()), 5);
+    EXPECT_THROW(net.setPropagation('s'), std::domain_error);
+    //the inputs on their way are part of the state
+    for (int step(0); step < 20; ++step) net.update();
+    const std::string state(net.getState());
+    std::vector<std::vector<uint64_t>> spikes;
+    for (int step(0); step < 30; ++step) {
+        net.update();
+        spikes.push_back(net.getSpikes());
+    }
+    net.setState(state);
+    EXPECT_EQ(net.getMaxDelay(), 5);
+    for (int step(0); step < 30; ++step) {
+        net.update();
+        EXPECT_EQ(net.getSpikes(), spikes[step]);
+    }
+}
+
+TEST(Network, precision) {
+    Random random(SEED);
+    Network net(_MOD_, 1000, _PERC_, _INT_, _LAMB_, _DEL_, random);
+    EXPECT_EQ(net.getPrecision(), 'd');
+    EXPECT_EQ(net.getWeightError(), 0);
+    EXPECT_THROW(net.setPrecision('h'), std::domain_error);
+    net.setSynchronous(true);
+    EXPECT_THROW(net.setPrecision('x'), std::domain_error);
+    const SynapseMatrix con(net.getCon());
+    net.setPrecision('f');
+    EXPECT_LT(net.getWeightError(), 1e-5);
+    //the intensities are only stored in the reduced precision, and the neurons in float
+    EXPECT_EQ(net.getCon().precision(), 'f');
+    EXPECT_EQ(net.getCon().weights(), nullptr);
+    EXPECT_TRUE(net.getNeurons().isSinglePrecision());
+    EXPECT_EQ(net.getCon().bytes() - con.nonZeros()*sizeof(float), con.bytes() - con.nonZeros()*sizeof(double));
+    net.setPrecision('h');
+    EXPECT_GT(net.getWeightError(), 0);
+    EXPECT_LT(net.getWeightError(), 1e-3);
+    EXPECT_NEAR(net.getValence(10), con.valence(10), con.degree(10)*1e-3);
+    //the 16-bit intensities are encoded again into the same integers
+    const SynapseMatrix back(net.getCon().withPrecision('d').withPrecision('h'));
+    EXPECT_EQ(back.unit(), net.getCon().unit());
+    EXPECT_TRUE(std::equal(back.weights16(), back.weights16() + con.nonZeros(), net.getCon().weights16()));
+    EXPECT_THROW(net.setSynchronous(false), std::domain_error);
+    //the precision is part of the state
+    for (int step(0); step < 20; ++step) net.update();
+    const std::string state(net.getState());
+    std::vector<std::vector<uint64_t>> spikes;
+    for (int step(0); step < 30; ++step) {
+        net.update();
+        spikes.push_back(net.getSpikes());
+    }
+    net.setPrecision('d');
+    net.setState(state);
+    EXPECT_EQ(net.getPrecision(), 'h');
+    for (int step(0); step < 30; ++step) {
+        net.update();
+        EXPECT_EQ(net.getSpikes(), spikes[step]);
+    }
+}
+
+TEST(Network, synchronous) {
+    Random first(4321), second(4321);
+    Network scan(_MOD_, 1000, _PERC_, _INT_, _LAMB_, _DEL_, first);
+    scan.setSynchronous(true);
+    scan.setThreads(3);
+    Network events(_MOD_, 1000, _PERC_, _INT_, _LAMB_, _DEL_, second);
+    events.setPropagation('e');
+    EXPECT_TRUE(events.isSynchronous());
+    EXPECT_THROW(events.setSynchronous(false), std::domain_error);
+    size_t spikes(0);
+    for (int step(0); step < 100; ++step) {
+        scan.update();
+        events.update();
+        ASSERT_EQ(scan.getSpikes(), events.getSpikes());
+        std::vector<bool> status(scan.getCurrentstatus());
+        for (auto fired: events.getFired()) {
+            EXPECT_TRUE(status[fired]);
+        }
+        spikes += events.getFired().size();
+        EXPECT_EQ(size_t(std::count(status.begin(), status.end(), true)), events.getFired().size());
+    }
+    EXPECT_GT(spikes, 0);
+}
+
+TEST(Network, distributed) {
+    Random random(11);
+    Network net('b', 300, 0.2, 0.1, 0, 0, 0, 0.1, _INT_, 30, _DEL_, random, 'p', 2);
+    net.setSynchronous(true);
+    //three ranks in one process, their spikes being exchanged by hand
+    const size_t ranks(3);
+    std::vector<std::unique_ptr<DistributedNetwork>> parts;
+    for (size_t rank(0); rank < ranks; ++rank) {
+        Random seeded(11);
+        parts.emplace_back(new DistributedNetwork(rank, ranks, 'b', DistributedNetwork::typeCounts(300, 0.2, 0.1, 0, 0, 0, 0.1),
+                                                  _INT_, 30, _DEL_, net.getNoiseSeed(), seeded, 1 + rank));
+    }
+    EXPECT_EQ(parts[1]->getBegin(), 64);
+    EXPECT_EQ(parts[2]->getEnd(), 300);
+    EXPECT_THROW(DistributedNetwork(3, 3, 'b', DistributedNetwork::typeCounts(300, 0.8), _INT_, 30, _DEL_, 0, random), std::domain_error);
+    for (auto& part: parts) {
+        for (size_t i(part->getBegin()); i < part->getEnd(); ++i) {
+            const size_t local(i - part->getBegin());
+            EXPECT_EQ(part->getNeurons().getType(local), net.getNeurons().getType(i));
+            EXPECT_EQ(part->getNeurons().getAttributs(local), net.getNeurons().getAttributs(i));
+            ASSERT_EQ(part->getCon().degree(local), net.getCon().degree(i));
+            for (size_t k(0); k < net.getCon().degree(i); ++k) {
+                EXPECT_EQ(part->getCon().source(local, k), net.getCon().source(i, k));
+                EXPECT_EQ(part->getCon().weight(local, k), net.getCon().weight(i, k));
+            }
+        }
+    }
+    size_t spikes(0);
+    for (int step(0); step < 100; ++step) {
+        net.update();
+        std::vector<uint64_t> gathered;
+        for (auto& part: parts) {
+            part->update();
+            gathered.insert(gathered.end(), part->getLocalSpikes().begin(), part->getLocalSpikes().end());
+        }
+        ASSERT_EQ(gathered, net.getSpikes());
+        for (auto& part: parts) {
+            part->setSpikes(gathered);
+        }
+        for (auto word: gathered) spikes += __builtin_popcountll(word);
+    }
+    EXPECT_GT(spikes, 0);
+    EXPECT_THROW(parts[0]->setSpikes(std::vector<uint64_t>(2, 0)), std::domain_error);
+}
+
+TEST(Engine, run) {
+    EngineConfig config;
+    config.neurons = 300;
+    config.lambda = 20;
+    config.types = {{"FS", 0.2}, {"CH", 0.1}};
+    config.construction = 'p';
+    config.threads = 2;
+    config.synchronous = true;
+    Engine engine(config, 17);
+    EXPECT_EQ(engine.getSeed(), 17);
+    EXPECT_EQ(engine.size(), 300);
+    //the same network as neuron_network -s 17, built and updated from the streams of the seed
+    const Random root(17);
+    Random random(root.substream(Random::PARAMETERS));
+    Network net('b', 300, 0.2, 0, 0, 0, 0, 0.1, _INT_, 20, _DEL_, random, 'p', 2);
+    random = root.substream(Random::NOISE);
+    net.setSynchronous(true);
+    uint64_t calls(0);
+    std::vector<uint64_t> fired;
+    engine.onSpikes([&calls, &fired](uint64_t step, const Span<uint64_t>& spikes) {
+        calls += 1;
+        EXPECT_EQ(step, calls);
+        fired.assign(spikes.begin(), spikes.end());
+    });
+    size_t spikes(0);
+    for (int step(0); step < 50; ++step) {
+        engine.step();
+        net.update();
+        ASSERT_EQ(fired, net.getSpikes());
+        for (auto word: fired) spikes += __builtin_popcountll(word);
+    }
+    EXPECT_GT(spikes, 0);
+    engine.step(10);
+    EXPECT_EQ(engine.steps(), 60);
+    EXPECT_EQ(calls, 60);
+    //the variables are read in place
+    EXPECT_EQ(engine.potentials().size(), 300);
+    EXPECT_EQ(engine.potentials().data(), engine.network().getNeurons().columns()[4]);
+    EXPECT_EQ(engine.recoveries()[7], engine.network().getNeurons().getVariables(7)[1]);
+    EXPECT_EQ(engine.currents()[7], engine.network().getNeurons().getVariables(7)[2]);
+    EXPECT_EQ(engine.spikes().size(), 5);
+    //in float, the variables are read through a copy in double
+    config.precision = 'f';
+    Engine single(config, 1);
+    single.step(5);
+    EXPECT_EQ(single.potentials()[7], single.network().getNeurons().getVariables(7)[0]);
+    config.precision = _PRECISION_;
+    config.types = {{"RS", 0.5}};
+    EXPECT_THROW(Engine(config, 1), std::domain_error);
+    config.types.clear();
+    config.threads = 0;
+    EXPECT_THROW(Engine(config, 1), std::domain_error);
+}
+
+TEST(NeuronPool, kernels) {
+    Random random(SEED);
+    const size_t n(203);
+    NeuronPool reference;
+    for (size_t i(0); i < n; ++i) {
+        reference.add(i % 2 ? "RS" : "FS", 1, 1);
+        reference.setAttributs(i, random.uniform_double(0.01, 0.1), random.uniform_double(0.2, 0.3),
+                               random.uniform_double(-65, -50), random.uniform_double(0.05, 8));
+    }
+    std::vector<std::string> kernels(availableKernels());
+    EXPECT_EQ(kernels.back(), "scalar");
+    EXPECT_THROW(integrationKernel("none"), std::domain_error);
+    for (auto& name: kernels) {
+        for (bool single: {false, true}) {
+            NeuronPool pool(reference);
+            pool.setKernel(name);
+            pool.setSinglePrecision(single);
+            NeuronPool expected(reference);
+            expected.setSinglePrecision(single);
+            std::vector<uint64_t> spikes(4), expectedSpikes(4);
+            for (int step(0); step < 50; ++step) {
+                for (size_t i(0); i < n; ++i) {
+                    double current(random.uniform_double(-5, 25));
+                    pool.setCurrent(i, current);
+                    expected.setCurrent(i, current);
+                    expected.update(i);
+                    expectedSpikes[i / 64] = (expectedSpikes[i / 64] & ~(uint64_t(1) << (i % 64)))
+                                             | (uint64_t(expected.isFiring(i)) << (i % 64));
+                }
+                pool.update(0, n, spikes.data());
+                ASSERT_EQ(spikes, expectedSpikes) << name;
+                for (size_t i(0); i < n; ++i) {
+                    ASSERT_EQ(pool.getVariables(i), expected.getVariables(i)) << name;
+                }
+            }
+        }
+    }
+}
+
+TEST(ThreadPool, run) {
+    ThreadPool threads(4);
+    EXPECT_EQ(threads.size(), 4);
+    std::vector<int> done(1000, 0);
+    threads.run(done.size(), [&done](size_t i) {done[i] += 1;});
+    threads.run(done.size(), [&done](size_t i) {done[i] += 1;});
+    for (auto d: done) EXPECT_EQ(d, 2);
+    EXPECT_THROW(threads.run(10, [](size_t i) {if (i == 5) throw std::runtime_error("task");}), std::runtime_error);
+}
+
+TEST(OutputQueue, order) {
+    std::vector<int> written;
+    OutputQueue queue(4, [&written] (const OutputFrame& frame) {
+        EXPECT_EQ(frame.spikes.size(), 1);
+        EXPECT_EQ(frame.spikes[0], uint64_t(frame.step));
+        written.push_back(frame.step);
+    });
+    for (int step(1); step <= 1000; ++step) {
+        OutputFrame& frame(queue.acquire());
+        frame.step = step;
+        frame.spikes.assign(1, step);
+        queue.publish();
+    }
+    queue.close();
+    ASSERT_EQ(written.size(), 1000);
+    for (int step(1); step <= 1000; ++step) EXPECT_EQ(written[step - 1], step);
+
+    OutputQueue failing(2, [] (const OutputFrame& frame) {if (frame.step == 3) throw std::runtime_error("disk full");});
+    for (int step(1); step <= 10; ++step) {
+        failing.acquire().step = step;
+        failing.publish();
+    }
+    EXPECT_THROW(failing.close(), std::runtime_error);
+}
+
+TEST(Random, counter) {
+    EXPECT_EQ(Random::counter_hash(1, 2, 3), Random::counter_hash(1, 2, 3));
+    EXPECT_NE(Random::counter_hash(1, 2, 3), Random::counter_hash(1, 3, 2));
+    double mean(0), var(0);
+    for (int i(0); i < 10000; ++i) {
+        double x(Random::counter_normal(42, i % 100, i / 100));
+        mean += x*1e-4;
+        var += x*x*1e-4;
+    }
+    EXPECT_NEAR(mean, 0, 3e-2);
+    EXPECT_NEAR(var, 1, 5e-2);
+}
+
+TEST(Random, bulk) {
+    //the bulk noise gives the numbers of each stream, whatever the first stream and the parity of the count
+    std::vector<double> noise(101);
+    Random::counter_normals(7, 3, 5, noise.size(), noise.data());
+    for (size_t i(0); i < noise.size(); ++i) {
+        EXPECT_EQ(noise[i], Random::counter_normal(7, 3 + i, 5));
+    }
+    //the normal number kept between two draws is part of the state
+    Random random(42);
+    random.normal();
+    const std::string state(random.getState());
+    const double next(random.normal());
+    random.setState(state);
+    EXPECT_EQ(random.normal(), next);
+}
+
+TEST(Random, substream) {
+    //the streams only depend on the seed, and not on the numbers already drawn
+    Random random(42), other(42);
+    other.normal();
+    other.uniform_int();
+    Random parameters(random.substream(Random::PARAMETERS)), noise(random.substream(Random::NOISE));
+    EXPECT_EQ(parameters.getState(), other.substream(Random::PARAMETERS).getState());
+    EXPECT_EQ(noise.uniform_uint64(), other.substream(Random::NOISE).uniform_uint64());
+    EXPECT_NE(parameters.uniform_uint64(), random.substream(Random::TOPOLOGY).uniform_uint64());
+    EXPECT_NE(random.substream(Random::TOPOLOGY).getSeed(), Random(43).substream(Random::TOPOLOGY).getSeed());
+    //the seeds differing only by their high bits give different sequences
+    Random high(42 + (uint64_t(1) << 32));
+    EXPECT_NE(high.uniform_uint64(), Random(42).uniform_uint64());
 }
 
 TEST(Network, current) {
-    Network net(_MOD_, _NB_TEST_, _PERC_, _INT_, _LAMB_, _DEL_);
+    Random random(SEED);
+    Network net(_MOD_, _NB_TEST_, _PERC_, _INT_, _LAMB_, _DEL_, random);
+    const SynapseMatrix& con(net.getCon());
     double variables = 0.0;
     double variables_updated = 0.0;
     for(size_t i(0); i<net.getNet().size(); ++i) {
         if(net.getNet()[i]->isFiring()) {
-            for (auto link : net.getCon()[i]) {
-                variables = link.first->getVariables().back();
+            for (size_t k(0); k<con.degree(i); ++k) {
+                Neuron* link(net.getNet()[con.source(i, k)]);
+                variables = link->getVariables().back();
                 net.synapticCurrent(i);
-                variables_updated = link.first->getVariables().back();
+                variables_updated = link->getVariables().back();
                 EXPECT_FALSE(variables == variables_updated);
             }
         }
     }
 }
 
+TEST(Network, pool) {
+    Random random(SEED);
+    Network net(_MOD_, _NB_TEST_, _PERC_, _INT_, _LAMB_, _DEL_, random);
+    const NeuronPool& pool(net.getNeurons());
+    std::vector<Neuron*> netw(net.getNet());
+    EXPECT_EQ(pool.size(), netw.size());
+    for (int step(0); step < 20; ++step) {
+        net.update();
+        for (size_t i(0); i < netw.size(); ++i) {
+            EXPECT_EQ(netw[i]->getIndex(), i);
+            EXPECT_EQ(netw[i]->getVariables(), pool.getVariables(i));
+            EXPECT_EQ(netw[i]->getAttributs(), pool.getAttributs(i));
+            EXPECT_EQ(netw[i]->getType(), pool.getType(i));
+            EXPECT_LE(pool.getVariables(i)[0], _DISCHARGE_T_);
+        }
+    }
+}
+
 TEST(Simulation, output) {
     Simulation sim(_SPIKES_);
-    int result = sim.run();
+    double result = sim.run();
+    EXPECT_GT(result, 0);
     EXPECT_LE(result, 60);
 
     std::ifstream myfile;
@@ -101,6 +896,8 @@ TEST(Simulation, output) {
     myfile.open(_SPIKES_);
     if (myfile.is_open()) {
         EXPECT_FALSE(myfile.eof());
+        ASSERT_TRUE(std::getline(myfile, print));
+        EXPECT_EQ(print, "# seed " + std::to_string(_RNG->getSeed()));
         int i(0);
         while (std::getline(myfile, print)) {
             print.erase(print.begin(), print.begin() + print.find(' '));
@@ -117,6 +914,174 @@ TEST(Simulation, output) {
     myfile.close();
 }
 
+TEST(Simulation, binary) {
+    NeuronPool pool;
+    for (int i(0); i < 70; ++i) pool.add(i < 20 ? "FS" : "RS", 1, 1);
+    RasterHeader header(RasterHeader::layout(pool));
+    header.steps = 3;
+    header.dt = 1;
+    header.seed = 99;
+    ASSERT_EQ(header.types.size(), 2);
+    EXPECT_EQ(header.types[0], std::make_pair(std::string("FS"), uint64_t(20)));
+    EXPECT_EQ(header.types[1], std::make_pair(std::string("RS"), uint64_t(50)));
+
+    std::vector<std::vector<uint64_t>> steps = {{0, 0}, {0x8000000000000001ULL, 0x20}, {~0ULL, 0x3F}};
+    std::stringstream binary, text, converted;
+    BinaryRasterWriter writer(binary, header);
+    TextRasterWriter reference(text, 70);
+    for (size_t k(0); k < steps.size(); ++k) {
+        writer.write(k + 1, steps[k]);
+        reference.write(k + 1, steps[k]);
+    }
+    EXPECT_EQ(binary.str().size(), 48 + 2*16 + 3*9);
+    RasterHeader read(RasterHeader::read(binary));
+    EXPECT_EQ(read.neurons, 70);
+    EXPECT_EQ(read.steps, 3);
+    EXPECT_EQ(read.seed, 99);
+    EXPECT_EQ(read.dt, 1);
+    EXPECT_EQ(read.types, header.types);
+    binary.seekg(0);
+    EXPECT_EQ(convertRaster(binary, converted), 3);
+    EXPECT_EQ(converted.str(), "# seed 99\n" + text.str());
+    std::stringstream wrong("not a raster");
+    EXPECT_THROW(RasterHeader::read(wrong), std::runtime_error);
+}
+
+TEST(Simulation, events) {
+    NeuronPool pool;
+    for (int i(0); i < 70; ++i) pool.add("RS", 1, 1);
+    RasterHeader header(RasterHeader::layout(pool));
+    header.steps = 5;
+    std::vector<std::vector<uint64_t>> steps = {{0, 0}, {0x8000000000000001ULL, 0x20}, {0, 0}, {~0ULL, 0x3F}, {0, 0}};
+    std::stringstream binary, events, text, converted;
+    {
+        EventBinaryWriter writer(binary, header);
+        EventTextWriter sparse(events, 70);
+        TextRasterWriter reference(text, 70);
+        for (size_t k(0); k < steps.size(); ++k) {
+            writer.write(k + 1, steps[k]);
+            sparse.write(k + 1, steps[k]);
+            reference.write(k + 1, steps[k]);
+        }
+    }
+    EXPECT_EQ(events.str().substr(0, 17), "2 0\n2 63\n2 69\n4 0");
+    //header, then 2 steps: (2, 3, 0, 63, 6) and (2, 70, 0, 1 x 69)
+    EXPECT_EQ(binary.str().size(), 48 + 16 + 5 + 72);
+    EXPECT_EQ(RasterHeader::read(binary).format, 'e');
+    binary.seekg(0);
+    EXPECT_EQ(convertRaster(binary, converted), 5);
+    EXPECT_EQ(converted.str(), "# seed 0\n" + text.str());
+    //a step with spikes after the last step of the header, then the same step twice
+    for (const std::string& written: {std::string("\x90\x4E\x01\x00", 4), std::string("\x02\x01\x00\x00\x01\x00", 6)}) {
+        std::stringstream corrupted, ignored;
+        RasterHeader events(header);
+        events.format = 'e';
+        events.write(corrupted);
+        corrupted << written;
+        EXPECT_THROW(convertRaster(corrupted, ignored), std::runtime_error);
+    }
+}
+
+TEST(Simulation, merge) {
+    NeuronPool pool;
+    for (int i(0); i < 150; ++i) pool.add(i < 30 ? "FS" : "RS", 1, 1);
+    std::vector<std::vector<uint64_t>> steps = {{0, 0, 0}, {0x8000000000000001ULL, 0x20, 0x3FFFFF}, {~0ULL, 0, 0x10}};
+    std::stringstream whole, converted, merged;
+    RasterHeader header(RasterHeader::layout(pool));
+    header.steps = steps.size();
+    header.seed = 5;
+    {
+        BinaryRasterWriter writer(whole, header);
+        for (size_t k(0); k < steps.size(); ++k) writer.write(k + 1, steps[k]);
+    }
+    //the ranks of a distributed simulation write their words of the raster, in either binary format
+    std::vector<std::unique_ptr<std::stringstream>> parts;
+    for (size_t rank(0); rank < 2; ++rank) {
+        NeuronPool neurons;
+        const size_t begin(64*rank), end(rank == 0 ? 64 : 150);
+        for (size_t i(begin); i < end; ++i) neurons.add(pool.getType(i), 1, 1);
+        RasterHeader local(RasterHeader::layout(neurons));
+        local.steps = steps.size();
+        local.seed = 5;
+        parts.emplace_back(new std::stringstream());
+        std::unique_ptr<SpikeWriter> writer;
+        if (rank == 0) writer.reset(new BinaryRasterWriter(*parts.back(), local));
+        else writer.reset(new EventBinaryWriter(*parts.back(), local));
+        for (size_t k(0); k < steps.size(); ++k) {
+            writer->write(k + 1, std::vector<uint64_t>(steps[k].begin() + rank, rank == 0 ? steps[k].begin() + 1 : steps[k].end()));
+        }
+        writer->flush();
+    }
+    EXPECT_EQ(convertRaster(whole, converted), 3);
+    EXPECT_EQ(mergeRasters({parts[0].get(), parts[1].get()}, merged), 3);
+    EXPECT_EQ(merged.str(), converted.str());
+    //the rasters of different simulations are not merged
+    std::stringstream other, wrong;
+    header.seed = 6;
+    BinaryRasterWriter writer(other, header);
+    parts[0]->seekg(0);
+    EXPECT_THROW(mergeRasters({parts[0].get(), &other}, wrong), std::runtime_error);
+}
+
+TEST(Simulation, statistics) {
+    NeuronPool pool;
+    pool.add("FS", 2, 1);
+    pool.add("RS", 5, 1);
+    pool.add("RS", 5, 1);
+    SpikeStatistics statistics(pool, 1);
+    //neuron 0 fires at steps 1, 3 and 5, neuron 1 at steps 2, 6 and 8, neuron 2 never
+    const std::vector<uint64_t> fired = {1, 2, 1, 0, 1, 2, 0, 2};
+    for (size_t step(0); step < fired.size(); ++step) {
+        statistics.add(step + 1, std::vector<uint64_t>(1, fired[step]));
+    }
+    EXPECT_EQ(statistics.steps(), 8);
+    EXPECT_EQ(statistics.getSpikes(0), 3);
+    EXPECT_DOUBLE_EQ(statistics.getRate(0), 375);
+    EXPECT_DOUBLE_EQ(statistics.getIsiMean(0), 2);
+    EXPECT_DOUBLE_EQ(statistics.getIsiCv(0), 0);
+    EXPECT_DOUBLE_EQ(statistics.getIsiMean(1), 3);
+    EXPECT_DOUBLE_EQ(statistics.getIsiCv(1), 1./3);
+    EXPECT_EQ(statistics.getSpikes(2), 0);
+    EXPECT_DOUBLE_EQ(statistics.getIsiCv(2), 0);
+    EXPECT_DOUBLE_EQ(statistics.getTypeRate(NeuronType::FS), 375);
+    EXPECT_DOUBLE_EQ(statistics.getTypeRate(NeuronType::RS), 187.5);
+    EXPECT_DOUBLE_EQ(statistics.getTypeRate(NeuronType::IB), 0);
+    EXPECT_EQ(statistics.getPopulation(), std::vector<uint32_t>({1, 1, 1, 0, 1, 1, 0, 1}));
+    EXPECT_EQ(SpikeStatistics::populationFile("summary.txt"), "summary_population.txt");
+    std::ostringstream summary;
+    statistics.write(summary, 7);
+    EXPECT_EQ(summary.str().substr(0, 9), "# seed 7\n");
+    EXPECT_NE(summary.str().find("\n1\t RS\t 3\t 375\t 3\t "), std::string::npos);
+}
+
+TEST(Simulation, sweep) {
+    std::map<char, std::vector<double>> grid(Sweep::parseGrid("L=10,20;l=2:6:2; d=0.1"));
+    EXPECT_EQ(grid['L'], std::vector<double>({10, 20}));
+    EXPECT_EQ(grid['l'], std::vector<double>({2, 4, 6}));
+    EXPECT_THROW(Sweep::parseGrid("N=10"), std::domain_error);
+    EXPECT_THROW(Sweep::parseGrid("L=a"), std::domain_error);
+
+    const Sweep::Point defaults = {_INT_, _LAMB_, _PERC_, _DEL_};
+    Sweep sweep("L=10,20,40;p=0.5,0.8", defaults, _MOD_, 100, 's', 'p', 20, 't', "sweep_test.txt", 2);
+    ASSERT_EQ(sweep.getPoints().size(), 6);
+    EXPECT_EQ(sweep.topologies(), 2);
+    EXPECT_EQ(sweep.outputFile(3), "sweep_test_3.txt");
+    sweep.run();
+    std::ifstream index(sweep.indexFile());
+    std::string line;
+    int lines(0);
+    while (std::getline(index, line)) lines += 1;
+    EXPECT_EQ(lines, 7);
+    for (size_t run(0); run < sweep.getPoints().size(); ++run) {
+        std::ifstream output(sweep.outputFile(run));
+        int steps(0);
+        while (std::getline(output, line)) steps += (line[0] != '#');
+        EXPECT_EQ(steps, 20);
+        std::remove(sweep.outputFile(run).c_str());
+    }
+    std::remove(sweep.indexFile().c_str());
+}
+
 TEST(Simulation, readLine) {
     Simulation sim(_SPIKES_);
     double FS(0.), IB(0.), RZ(0.), LTS(0.), TC(0.), CH(0.);
@@ -132,12 +1097,13 @@ TEST(Simulation, readLine) {
 }
 
 TEST(Neuron, attributs){
+    Random random(SEED);
     double r=1.0;
-    ExcitatoryNeuron* excitatory_RS = new ExcitatoryNeuron(r, "RS");
-    ExcitatoryNeuron* excitatory_IB = new ExcitatoryNeuron(r, "IB");
-    ExcitatoryNeuron* excitatory_CH = new ExcitatoryNeuron(r, "CH");
-    InhibitoryNeuron* inhibitory_LTS = new InhibitoryNeuron(r, "LTS");
-    InhibitoryNeuron* inhibitory_FS = new InhibitoryNeuron(r, "FS");
+    ExcitatoryNeuron* excitatory_RS = new ExcitatoryNeuron(r, random, "RS");
+    ExcitatoryNeuron* excitatory_IB = new ExcitatoryNeuron(r, random, "IB");
+    ExcitatoryNeuron* excitatory_CH = new ExcitatoryNeuron(r, random, "CH");
+    InhibitoryNeuron* inhibitory_LTS = new InhibitoryNeuron(r, random, "LTS");
+    InhibitoryNeuron* inhibitory_FS = new InhibitoryNeuron(r, random, "FS");
     std::vector<double> excit_attributs_RS = {_RS_A_, _RS_B_, _RS_C_, _RS_D_};
     std::vector<double> excit_attributs_IB = {_IB_A_, _IB_B_, _IB_C_, _IB_D_};
     std::vector<double> excit_attributs_CH = {_CH_A_, _CH_B_, _CH_C_, _CH_D_};
@@ -153,9 +1119,10 @@ TEST(Neuron, attributs){
 }
 
 TEST(Neuron, update){
+    Random random(SEED);
     double r=0.5;
-    ExcitatoryNeuron* excitatory = new ExcitatoryNeuron(r);
-    InhibitoryNeuron* inhibitory = new InhibitoryNeuron(r);
+    ExcitatoryNeuron* excitatory = new ExcitatoryNeuron(r, random);
+    InhibitoryNeuron* inhibitory = new InhibitoryNeuron(r, random);
     std::vector<double> excit_variablesInitial = excitatory->getVariables();
     std::vector<double> inhib_varaiblesInitial = inhibitory->getVariables();
     excitatory->update();